@@ -0,0 +1,65 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/backend/planners/chasing_planner.h"
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+using namespace my_robotics_library;
+using namespace my_robotics_library::backend;
+
+// Candidate scoring with 1..N threads on a cluttered 20 m cube; Arg is the
+// thread count including the caller.
+static void BM_SamplingChasingPlan(benchmark::State &state) {
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> coordinate(-10.0, 10.0);
+  ObstacleManager obstacle_manager;
+  for (int n = 0; n < 2000; n++)
+    obstacle_manager.InsertObstacle({0, coordinate(generator),
+                                     coordinate(generator),
+                                     coordinate(generator)});
+
+  ThreadPool thread_pool(state.range(0));
+  ChasingSamplingParameter parameter;
+  parameter.num_azimuths = 32;
+  parameter.num_elevations = 4;
+  parameter.num_distances = 8;
+  ChasingPlanner chasing_planner;
+  chasing_planner.EnableSampling(parameter, 0.5, &obstacle_manager,
+                                 &thread_pool);
+
+  ChasingPlannerInput input;
+  input.target_position = {0, 3.0, 0, 0};
+  input.target_velocity = {0, 1.0, 0.5, 0};
+  for (auto _ : state) {
+    auto result = chasing_planner.ComputeChasingMotion(input);
+    benchmark::DoNotOptimize(result);
+  }
+  state.counters["candidates"] =
+      parameter.num_azimuths * parameter.num_elevations *
+      parameter.num_distances;
+}
+BENCHMARK(BM_SamplingChasingPlan)
+    ->RangeMultiplier(2)
+    ->Range(1, std::max(1u, std::thread::hardware_concurrency()))
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,192 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/backend/obstacle_manager.h"
+#include "my_robotics_library/backend/point_cloud_ingestor.h"
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <random>
+
+using namespace my_robotics_library;
+using namespace my_robotics_library::backend;
+
+// Obstacles are spread uniformly in a 100 m cube; queries land anywhere in it.
+std::vector<TimedPosition> GenerateObstacles(size_t num_obstacles,
+                                             uint32_t seed) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> coordinate(-50.0, 50.0);
+  std::vector<TimedPosition> positions(num_obstacles);
+  for (auto &position : positions)
+    position = {0.0, coordinate(generator), coordinate(generator),
+                coordinate(generator)};
+  return positions;
+}
+
+static void BM_GetDistanceToObstacle(benchmark::State &state) {
+  ObstacleManager obstacle_manager(1.0, 3.0);
+  obstacle_manager.InsertObstacles(GenerateObstacles(state.range(0), 1));
+  auto queries = GenerateObstacles(4096, 2);
+
+  size_t n = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        obstacle_manager.GetDistanceToObstacle(queries[n++ % queries.size()]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetDistanceToObstacle)->RangeMultiplier(10)->Range(10000, 1000000);
+
+static void BM_InsertObstacles(benchmark::State &state) {
+  auto positions = GenerateObstacles(state.range(0), 1);
+  for (auto _ : state) {
+    ObstacleManager obstacle_manager(1.0, 3.0);
+    obstacle_manager.InsertObstacles(positions);
+    benchmark::DoNotOptimize(obstacle_manager.GetNumObstacles());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_InsertObstacles)
+    ->RangeMultiplier(10)
+    ->Range(10000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_UpdateObstacle(benchmark::State &state) {
+  ObstacleManager obstacle_manager(1.0, 3.0);
+  std::vector<ObstacleId> ids;
+  obstacle_manager.InsertObstacles(GenerateObstacles(state.range(0), 1), &ids);
+  auto moves = GenerateObstacles(4096, 3);
+
+  size_t n = 0;
+  for (auto _ : state) {
+    obstacle_manager.UpdateObstacle(ids[n % ids.size()],
+                                    moves[n % moves.size()]);
+    n++;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UpdateObstacle)->RangeMultiplier(10)->Range(10000, 1000000);
+
+// The distance field covers a 40 x 40 x 10 m box at 0.2 m in the middle of
+// the obstacle cube.
+DistanceFieldConfig GetBenchmarkFieldConfig() {
+  DistanceFieldConfig config;
+  config.origin_x = -20.0;
+  config.origin_y = -20.0;
+  config.origin_z = -5.0;
+  config.resolution = 0.2;
+  config.size_x = config.size_y = 201;
+  config.size_z = 51;
+  return config;
+}
+
+std::vector<TimedPosition> GenerateFieldQueries(size_t num_queries) {
+  std::mt19937 generator(4);
+  std::uniform_real_distribution<double> horizontal(-19.0, 19.0);
+  std::uniform_real_distribution<double> vertical(-4.0, 4.0);
+  std::vector<TimedPosition> queries(num_queries);
+  for (auto &query : queries)
+    query = {0.0, horizontal(generator), horizontal(generator),
+             vertical(generator)};
+  return queries;
+}
+
+static void BM_GetDistanceToObstacleField(benchmark::State &state) {
+  ObstacleManager obstacle_manager(1.0, 3.0);
+  obstacle_manager.InsertObstacles(GenerateObstacles(state.range(0), 1));
+  obstacle_manager.EnableDistanceField(GetBenchmarkFieldConfig());
+  auto queries = GenerateFieldQueries(4096);
+
+  size_t n = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        obstacle_manager.GetDistanceToObstacle(queries[n++ % queries.size()]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetDistanceToObstacleField)
+    ->RangeMultiplier(10)
+    ->Range(10000, 100000)
+    ->Unit(benchmark::kNanosecond);
+
+static void BM_GetDistancesToObstacleFieldBatch(benchmark::State &state) {
+  ObstacleManager obstacle_manager(1.0, 3.0);
+  obstacle_manager.InsertObstacles(GenerateObstacles(10000, 1));
+  obstacle_manager.EnableDistanceField(GetBenchmarkFieldConfig());
+  auto queries = GenerateFieldQueries(state.range(0));
+  std::vector<double> xs, ys, zs, distances(queries.size());
+  for (const auto &query : queries) {
+    xs.push_back(query.x);
+    ys.push_back(query.y);
+    zs.push_back(query.z);
+  }
+
+  for (auto _ : state) {
+    obstacle_manager.GetDistancesToObstacle(xs.data(), ys.data(), zs.data(),
+                                            queries.size(), distances.data());
+    benchmark::DoNotOptimize(distances.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GetDistancesToObstacleFieldBatch)->Arg(1000)->Arg(10000);
+
+static void BM_UpdateObstacleField(benchmark::State &state) {
+  ObstacleManager obstacle_manager(1.0, 3.0);
+  std::vector<ObstacleId> ids;
+  obstacle_manager.InsertObstacles(GenerateObstacles(10000, 1), &ids);
+  obstacle_manager.EnableDistanceField(GetBenchmarkFieldConfig());
+  auto moves = GenerateFieldQueries(4096);
+
+  size_t n = 0;
+  for (auto _ : state) {
+    obstacle_manager.UpdateObstacle(ids[n % ids.size()],
+                                    moves[n % moves.size()]);
+    n++;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UpdateObstacleField)->Unit(benchmark::kMicrosecond);
+
+// Depth frames of a 640 x 480 camera looking at a wavy wall 3-5 m away,
+// ingested at 30 Hz of simulated time into a one second window
+static void BM_IngestPointCloud(benchmark::State &state) {
+  const int width = 640, height = 480;
+  std::vector<float> xyz;
+  xyz.reserve(3 * width * height);
+  for (int v = 0; v < height; v++) {
+    for (int u = 0; u < width; u++) {
+      float depth = 4.0f + std::sin(0.02f * u) * std::cos(0.03f * v);
+      xyz.insert(xyz.end(), {depth, depth * (u - width / 2) / 500.0f,
+                             depth * (v - height / 2) / 500.0f});
+    }
+  }
+  PointCloudView cloud{xyz.data(), xyz.size() / 3, 3 * sizeof(float)};
+
+  ObstacleManager obstacle_manager;
+  PointCloudIngestor ingestor(obstacle_manager, PointCloudParameter());
+  double t = 0.0;
+  for (auto _ : state) {
+    ingestor.Ingest(cloud, t);
+    t += 1.0 / 30;
+  }
+  state.counters["voxels"] = ingestor.GetNumObservedVoxels();
+  state.SetItemsProcessed(state.iterations() * cloud.num_points);
+}
+BENCHMARK(BM_IngestPointCloud)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
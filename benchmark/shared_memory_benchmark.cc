@@ -0,0 +1,167 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/frontend/shared_memory_transport.h"
+#include "my_robotics_library/frontend/wrapper.h"
+#include <benchmark/benchmark.h>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace my_robotics_library;
+
+// Round trips between this process and a forked peer that maps the channel
+// by name. Both sides poll and yield while their ring is empty, so on a
+// single core the numbers include a context switch per hop; pin the two
+// processes to separate cores for the transport cost alone.
+
+namespace {
+// Forks a peer running body on a freshly opened mapping of the channel.
+// The peer runs until it is killed.
+pid_t SpawnPeer(const std::string &name,
+                const std::function<void(SharedMemoryChannel &)> &body) {
+  pid_t child = fork();
+  if (child != 0)
+    return child;
+  SharedMemoryChannel channel;
+  if (!channel.Open(name))
+    _exit(1);
+  body(channel);
+  _exit(0);
+}
+
+void StopPeer(pid_t child) {
+  kill(child, SIGKILL);
+  waitpid(child, nullptr, 0);
+}
+
+// Times every round trip and reports p50/p99/p99.9 counters.
+template <typename RoundTrip>
+void MeasureRoundTrips(benchmark::State &state, RoundTrip &&round_trip) {
+  std::vector<double> latencies;
+  latencies.reserve(state.max_iterations);
+  for (auto _ : state) {
+    auto begin = std::chrono::steady_clock::now();
+    round_trip();
+    auto end = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(end - begin).count();
+    latencies.push_back(elapsed * 1e9);
+    state.SetIterationTime(elapsed);
+  }
+  if (latencies.empty())
+    return;
+  auto percentile = [&](double ratio) {
+    size_t index = std::min(latencies.size() - 1,
+                            static_cast<size_t>(ratio * latencies.size()));
+    std::nth_element(latencies.begin(), latencies.begin() + index,
+                     latencies.end());
+    return latencies[index];
+  };
+  state.counters["p50_ns"] = percentile(0.5);
+  state.counters["p99_ns"] = percentile(0.99);
+  state.counters["p999_ns"] = percentile(0.999);
+}
+
+std::string GetChannelName() {
+  return "/mrl_benchmark_" + std::to_string(getpid());
+}
+} // namespace
+
+// Transport alone: the peer echoes every sensor message as an output.
+static void BM_RingRoundTrip(benchmark::State &state) {
+  auto name = GetChannelName();
+  SharedMemoryChannel channel;
+  if (!channel.Create(name)) {
+    state.SkipWithError("shm_open failed");
+    return;
+  }
+  pid_t peer = SpawnPeer(name, [](SharedMemoryChannel &peer_channel) {
+    SensorMessage request;
+    WrapperOutputMessage reply;
+    while (true) {
+      if (!peer_channel.GetSensorRing().TryPop(request)) {
+        std::this_thread::yield();
+        continue;
+      }
+      reply.t = request.data[0];
+      while (!peer_channel.GetOutputRing().TryPush(reply))
+        std::this_thread::yield();
+    }
+  });
+
+  SharedMemoryClient client(channel);
+  double sequence = 0.0;
+  MeasureRoundTrips(state, [&] {
+    client.SendPosition({++sequence, 0, 0, 0});
+    WrapperOutputMessage reply;
+    while (!client.Receive(reply))
+      std::this_thread::yield();
+    if (reply.t != sequence)
+      state.SkipWithError("reply out of order");
+  });
+  StopPeer(peer);
+}
+BENCHMARK(BM_RingRoundTrip)->UseManualTime();
+
+// A frontend sends a position and waits for the control of the tick that
+// consumed it from a hovering Wrapper in the peer process.
+static void BM_WrapperRoundTrip(benchmark::State &state) {
+  auto name = GetChannelName();
+  SharedMemoryChannel channel;
+  if (!channel.Create(name)) {
+    state.SkipWithError("shm_open failed");
+    return;
+  }
+  pid_t peer = SpawnPeer(name, [](SharedMemoryChannel &peer_channel) {
+    Wrapper wrapper;
+    SharedMemoryWrapperAdaptor adaptor(wrapper, peer_channel);
+    while (true) {
+      if (adaptor.Poll() == 0) {
+        std::this_thread::yield();
+        continue;
+      }
+      wrapper.OnTimerCallback();
+      adaptor.Publish();
+    }
+  });
+
+  SharedMemoryClient client(channel);
+  client.SendHoveringCommand();
+  double height = 0.0;
+  MeasureRoundTrips(state, [&] {
+    height = height < 1.0 ? height + 0.01 : 0.0;
+    client.SendPosition({0.0, 0, 0, height});
+    WrapperOutputMessage reply;
+    do {
+      while (!client.Receive(reply))
+        std::this_thread::yield();
+    } while (reply.type != WrapperOutputType::kControl);
+  });
+  StopPeer(peer);
+}
+BENCHMARK(BM_WrapperRoundTrip)->UseManualTime();
+
+BENCHMARK_MAIN();
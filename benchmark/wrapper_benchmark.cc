@@ -0,0 +1,349 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/wrapper.h"
+#include "my_robotics_library/frontend/wrapper_fleet.h"
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace my_robotics_library;
+using namespace my_robotics_library::backend;
+
+// Per-call latencies of one benchmark run, reported as p50/p99/p99.9 counters.
+// Calls are timed individually (manual time), so the setup that drives the
+// wrapper into the next scenario step stays out of the numbers.
+class LatencyHistogram {
+public:
+  explicit LatencyHistogram(benchmark::State &state) : state_(state) {
+    latencies_.reserve(state.max_iterations);
+  }
+  ~LatencyHistogram() {
+    if (latencies_.empty())
+      return;
+    state_.counters["p50_ns"] = Percentile(0.5);
+    state_.counters["p99_ns"] = Percentile(0.99);
+    state_.counters["p999_ns"] = Percentile(0.999);
+  }
+
+  template <typename Function> void Measure(Function &&function) {
+    auto begin = std::chrono::steady_clock::now();
+    function();
+    auto end = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(end - begin).count();
+    latencies_.push_back(elapsed * 1e9);
+    state_.SetIterationTime(elapsed);
+  }
+
+private:
+  benchmark::State &state_;
+  std::vector<double> latencies_;
+
+  double Percentile(double ratio) {
+    size_t index = std::min(latencies_.size() - 1,
+                            static_cast<size_t>(ratio * latencies_.size()));
+    std::nth_element(latencies_.begin(), latencies_.begin() + index,
+                     latencies_.end());
+    return latencies_[index];
+  }
+};
+
+constexpr double kTickPeriod = 0.01;
+
+// Scenarios mirror test/pipeline_test.cc
+
+static void BM_TimerTick_Hover(benchmark::State &state) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(clock);
+  wrapper.OnHoveringCommandCallback();
+  LatencyHistogram histogram(state);
+  for (auto _ : state) {
+    clock->Advance(kTickPeriod);
+    histogram.Measure([&] { wrapper.OnTimerCallback(); });
+  }
+}
+BENCHMARK(BM_TimerTick_Hover)->UseManualTime();
+
+static void BM_TimerTick_LowBatteryLanding(benchmark::State &state) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(clock);
+  LatencyHistogram histogram(state);
+  for (auto _ : state) {
+    wrapper.SetBatteryLevel(1);
+    wrapper.OnHoveringCommandCallback();
+    wrapper.SetBatteryLevel(0);
+    clock->Advance(kTickPeriod);
+    histogram.Measure([&] { wrapper.OnTimerCallback(); });
+  }
+}
+BENCHMARK(BM_TimerTick_LowBatteryLanding)->UseManualTime();
+
+static void BM_TimerTick_HoldStop(benchmark::State &state) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(clock);
+  wrapper.GetObstacleManager().InsertObstacle({0, 2.5, 0, 0});
+  wrapper.OnHoveringCommandCallback();
+  LatencyHistogram histogram(state);
+  bool is_dangerous = false;
+  for (auto _ : state) {
+    // alternates hold-stop and recovery to hovering
+    is_dangerous = !is_dangerous;
+    wrapper.SetPosition(is_dangerous ? TimedPosition{0, 2, 0, 0}
+                                     : TimedPosition{0, 0, 0, 0});
+    clock->Advance(kTickPeriod);
+    histogram.Measure([&] { wrapper.OnTimerCallback(); });
+  }
+}
+BENCHMARK(BM_TimerTick_HoldStop)->UseManualTime();
+
+static void BM_TimerTick_ChaseExploreCycle(benchmark::State &state) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(clock);
+  wrapper.OnHoveringCommandCallback();
+  wrapper.SetTargetPosition(TimedPosition{0, 3, 0, 0});
+  wrapper.OnChasingCommandCallback();
+  LatencyHistogram histogram(state);
+  bool is_visible = true;
+  for (auto _ : state) {
+    // alternates losing the target (explore) and re-detecting it (replan)
+    is_visible = !is_visible;
+    clock->Advance(kTickPeriod);
+    if (is_visible)
+      wrapper.SetTargetPosition(TimedPosition{clock->Now(), 3, 0, 0});
+    else
+      wrapper.SetTargetPosition(std::nullopt);
+    histogram.Measure([&] { wrapper.OnTimerCallback(); });
+  }
+}
+BENCHMARK(BM_TimerTick_ChaseExploreCycle)->UseManualTime();
+
+static void BM_TimerTick_ChaseSteady(benchmark::State &state) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(clock);
+  wrapper.OnHoveringCommandCallback();
+  wrapper.SetTargetPosition(TimedPosition{0, 3, 0, 0});
+  wrapper.OnChasingCommandCallback();
+  LatencyHistogram histogram(state);
+  for (auto _ : state) {
+    // target walks along x; replans every chasing_replan_period
+    clock->Advance(kTickPeriod);
+    wrapper.SetTargetPosition(
+        TimedPosition{clock->Now(), 3 + 0.5 * clock->Now(), 0, 0});
+    histogram.Measure([&] { wrapper.OnTimerCallback(); });
+  }
+}
+BENCHMARK(BM_TimerTick_ChaseSteady)->UseManualTime();
+
+static void BM_TimerTick_ChaseSteadyRecorded(benchmark::State &state) {
+  auto clock = std::make_shared<SimulatedClock>();
+  FlightRecorder flight_recorder;
+  std::string path = "wrapper_benchmark_flight.log";
+  if (!flight_recorder.Open(path, 8 * state.max_iterations + 16)) {
+    state.SkipWithError("cannot open the flight log");
+    return;
+  }
+  Wrapper wrapper(clock);
+  wrapper.SetFlightRecorder(&flight_recorder);
+  wrapper.OnHoveringCommandCallback();
+  wrapper.SetTargetPosition(TimedPosition{0, 3, 0, 0});
+  wrapper.OnChasingCommandCallback();
+  {
+    LatencyHistogram histogram(state);
+    for (auto _ : state) {
+      clock->Advance(kTickPeriod);
+      wrapper.SetTargetPosition(
+          TimedPosition{clock->Now(), 3 + 0.5 * clock->Now(), 0, 0});
+      histogram.Measure([&] {
+        wrapper.OnTimerCallback();
+        benchmark::DoNotOptimize(wrapper.GetControl());
+      });
+    }
+  }
+  state.counters["dropped"] = flight_recorder.GetNumDropped();
+  flight_recorder.Close();
+  std::remove(path.c_str());
+}
+BENCHMARK(BM_TimerTick_ChaseSteadyRecorded)->UseManualTime();
+
+static void BM_Command_Hovering(benchmark::State &state) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(clock);
+  LatencyHistogram histogram(state);
+  for (auto _ : state) {
+    clock->Advance(kTickPeriod);
+    histogram.Measure([&] { wrapper.OnHoveringCommandCallback(); });
+  }
+}
+BENCHMARK(BM_Command_Hovering)->UseManualTime();
+
+static void BM_Command_Chasing(benchmark::State &state) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(clock);
+  wrapper.OnHoveringCommandCallback();
+  LatencyHistogram histogram(state);
+  for (auto _ : state) {
+    clock->Advance(kTickPeriod);
+    wrapper.SetTargetPosition(TimedPosition{clock->Now(), 3, 1, 0});
+    histogram.Measure([&] { wrapper.OnChasingCommandCallback(); });
+  }
+}
+BENCHMARK(BM_Command_Chasing)->UseManualTime();
+
+static void BM_GetControl(benchmark::State &state) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(clock);
+  wrapper.OnHoveringCommandCallback();
+  if (state.range(0)) {
+    wrapper.SetTargetPosition(TimedPosition{0, 3, 0, 0});
+    wrapper.OnChasingCommandCallback();
+  }
+  LatencyHistogram histogram(state);
+  for (auto _ : state) {
+    clock->Advance(1e-4);
+    histogram.Measure([&] { benchmark::DoNotOptimize(wrapper.GetControl()); });
+  }
+}
+BENCHMARK(BM_GetControl)->ArgName("chasing")->Arg(0)->Arg(1)->UseManualTime();
+
+// One streamed sample of the chasing plan; the ring is drained in between
+static void BM_ControlStreamerStep(benchmark::State &state) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(clock);
+  ControlStreamer streamer(ControlStreamerOptions(), clock);
+  wrapper.SetControlStreamer(&streamer);
+  wrapper.OnHoveringCommandCallback();
+  wrapper.SetTargetPosition(TimedPosition{0, 3, 0, 0});
+  wrapper.OnChasingCommandCallback();
+  LatencyHistogram histogram(state);
+  Control control;
+  for (auto _ : state) {
+    clock->Advance(1e-4);
+    histogram.Measure([&] { benchmark::DoNotOptimize(streamer.Step()); });
+    streamer.GetRing(0).TryPop(control);
+  }
+}
+BENCHMARK(BM_ControlStreamerStep)->UseManualTime();
+
+static void BM_ComputeHeightMotion(benchmark::State &state) {
+  HeightPlanner height_planner;
+  height_planner.SetRobotPosition({0, 0, 0, 0.5});
+  HeightPlannerInput input;
+  input.target_height = 1.0;
+  MotionPlanningResultStore result_store;
+  LatencyHistogram histogram(state);
+  for (auto _ : state)
+    histogram.Measure(
+        [&] { height_planner.ComputeHeightMotion(input, result_store); });
+}
+BENCHMARK(BM_ComputeHeightMotion)->UseManualTime();
+
+static void BM_ComputeChasingMotion(benchmark::State &state) {
+  ChasingPlanner chasing_planner;
+  ChasingPlannerInput input;
+  input.target_position = {0, 3, 1, 0};
+  input.target_velocity = {0, 0.5, 0, 0};
+  input.robot_velocity = {0, 0.2, 0.1, 0};
+  MotionPlanningResultStore result_store;
+  LatencyHistogram histogram(state);
+  for (auto _ : state)
+    histogram.Measure(
+        [&] { chasing_planner.ComputeChasingMotion(input, result_store); });
+}
+BENCHMARK(BM_ComputeChasingMotion)->UseManualTime();
+
+static void BM_GetPlanningTrajectory(benchmark::State &state) {
+  ChasingPlanner chasing_planner(std::make_shared<SimulatedClock>());
+  ChasingPlannerInput input;
+  input.target_position = {0, 3, 1, 0};
+  auto result = chasing_planner.ComputeChasingMotion(input);
+  LatencyHistogram histogram(state);
+  for (auto _ : state)
+    histogram.Measure([&] {
+      benchmark::DoNotOptimize(result.GetPlanningTrajectory(0.0, 1.0));
+    });
+}
+BENCHMARK(BM_GetPlanningTrajectory)->UseManualTime();
+
+// Tick cost against the number of transitions held in the history
+static void BM_TimerTick_HistoryLength(benchmark::State &state) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(clock);
+  for (int64_t n = 0; n < state.range(0); n++)
+    wrapper.OnHoveringCommandCallback();
+  LatencyHistogram histogram(state);
+  for (auto _ : state) {
+    clock->Advance(kTickPeriod);
+    histogram.Measure([&] { wrapper.OnTimerCallback(); });
+  }
+  state.counters["history"] = wrapper.GetStateHistory().Size();
+}
+BENCHMARK(BM_TimerTick_HistoryLength)
+    ->RangeMultiplier(4)
+    ->Range(1, 1024)
+    ->UseManualTime();
+
+// One tick of every vehicle in a fleet of independent wrappers
+static void BM_TimerTick_FleetSize(benchmark::State &state) {
+  auto clock = std::make_shared<SimulatedClock>();
+  std::vector<std::unique_ptr<Wrapper>> fleet;
+  for (int64_t n = 0; n < state.range(0); n++) {
+    fleet.emplace_back(new Wrapper(clock));
+    fleet.back()->OnHoveringCommandCallback();
+    fleet.back()->SetTargetPosition(TimedPosition{0, 3.0 + n, 0, 0});
+    fleet.back()->OnChasingCommandCallback();
+  }
+  LatencyHistogram histogram(state);
+  for (auto _ : state) {
+    clock->Advance(kTickPeriod);
+    histogram.Measure([&] {
+      for (auto &wrapper : fleet)
+        wrapper->OnTimerCallback();
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TimerTick_FleetSize)
+    ->RangeMultiplier(4)
+    ->Range(1, 256)
+    ->UseManualTime();
+
+// The same fleet ticked as one batch
+static void BM_FleetTick(benchmark::State &state) {
+  auto clock = std::make_shared<SimulatedClock>();
+  WrapperFleet fleet(state.range(0), Parameter(), clock);
+  for (int64_t n = 0; n < state.range(0); n++) {
+    fleet.PostHoveringCommand(n);
+    fleet.SetTargetPosition(n, TimedPosition{0, 3.0 + n, 0, 0});
+    fleet.PostChasingCommand(n);
+  }
+  fleet.Tick();
+  LatencyHistogram histogram(state);
+  for (auto _ : state) {
+    clock->Advance(kTickPeriod);
+    histogram.Measure([&] { fleet.Tick(); });
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FleetTick)->RangeMultiplier(4)->Range(1, 256)->UseManualTime();
+
+BENCHMARK_MAIN();
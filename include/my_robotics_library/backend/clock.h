@@ -0,0 +1,77 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_CLOCK_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_CLOCK_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace my_robotics_library {
+
+// Source of time [s] for the pipeline. Swap in SimulatedClock to run
+// faster (or slower) than wall time.
+class Clock {
+public:
+  virtual ~Clock() = default;
+  virtual double Now() const = 0;
+};
+
+class SystemClock : public Clock {
+public:
+  double Now() const override;
+};
+
+// Time only moves when stepped explicitly.
+class SimulatedClock : public Clock {
+public:
+  explicit SimulatedClock(double t0 = 0.0) : time_(t0) {}
+  double Now() const override {
+    return time_.load(std::memory_order_acquire);
+  }
+  void SetTime(double t) { time_.store(t, std::memory_order_release); }
+  void Advance(double dt) { SetTime(Now() + dt); }
+
+private:
+  std::atomic<double> time_;
+};
+
+// Reads through to another clock, except while latched: then every read
+// returns the time of the Latch call. Lets all the reads of one callback
+// agree on a single time.
+class LatchedClock : public Clock {
+public:
+  explicit LatchedClock(std::shared_ptr<const Clock> source)
+      : source_(std::move(source)) {}
+  double Now() const override;
+  // returns the latched time
+  double Latch();
+  void Unlatch() { is_latched_.store(false, std::memory_order_release); }
+
+private:
+  std::shared_ptr<const Clock> source_;
+  std::atomic<double> latched_time_{0.0};
+  std::atomic<bool> is_latched_{false};
+};
+
+std::shared_ptr<const Clock> GetDefaultClock();
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_CLOCK_H_
@@ -16,18 +16,134 @@
  *
  *******************************************************************************/
 
-#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_TARGET_PREDICTOR_H_
-#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_TARGET_PREDICTOR_H_
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_OBSTACLE_MANAGER_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_OBSTACLE_MANAGER_H_
 #include "my_robotics_library/backend/types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 namespace my_robotics_library {
 namespace backend {
+
+using ObstacleId = uint32_t;
+
+struct TrajectoryClearance {
+  double min_clearance{0.0};
+  double min_clearance_time{0.0};
+  bool is_violated{false};
+  // time of the first sample closer than the safety distance
+  double first_violation_time{0.0};
+};
+
+// Dense grid of distance samples. Sample (i, j, k) sits at
+// origin + resolution * (i, j, k).
+struct DistanceFieldConfig {
+  double origin_x{-10.0};
+  double origin_y{-10.0};
+  double origin_z{0.0};
+  double resolution{0.2};
+  int size_x{101};
+  int size_y{101};
+  int size_z{26};
+  // Distances inside the grid saturate at this distance, clamped to the
+  // maximum query distance, and an edit only rewrites the samples within
+  // it of the edited obstacle [m]
+  double truncation_distance{2.0};
+};
+
+// Point obstacles bucketed in a sparse voxel hash. Nearest-distance queries
+// search voxel shells outwards from the query and stop as soon as no closer
+// obstacle can exist, so cost depends on local density, not on the total
+// number of obstacles. In sparse maps, where the next shell would take more
+// lookups than there are occupied voxels, they scan those voxels instead.
+//
+// With the distance field enabled, distances are also kept on a dense grid
+// truncated at DistanceFieldConfig::truncation_distance. Edits only touch
+// the samples within that distance of the edited obstacle, and queries
+// inside the grid are a trilinear lookup.
 class ObstacleManager {
 public:
-  ObstacleManager();
+  explicit ObstacleManager(double voxel_size = 0.5,
+                           double max_query_distance = 10.0);
+
+  ObstacleId InsertObstacle(const TimedPosition &position);
+  // ids of the inserted obstacles are appended to ids if given
+  void InsertObstacles(const std::vector<TimedPosition> &positions,
+                       std::vector<ObstacleId> *ids = nullptr);
+  bool UpdateObstacle(ObstacleId id, const TimedPosition &position);
+  // ids of removed obstacles may be reused by later insertions
+  bool RemoveObstacle(ObstacleId id);
+  void Clear();
+
+  size_t GetNumObstacles() const { return num_obstacles_; }
+  double GetMaxQueryDistance() const { return max_query_distance_; }
+
+  void EnableDistanceField(const DistanceFieldConfig &config);
+  void DisableDistanceField();
+  bool IsDistanceFieldEnabled() const { return !distance_field_.empty(); }
+
+  // Distance to the closest obstacle. Saturates at GetMaxQueryDistance(),
+  // or inside an enabled distance field at its truncation distance.
   double GetDistanceToObstacle(const TimedPosition &position) const;
+  // Batch query over positions in structure-of-arrays layout
+  void GetDistancesToObstacle(const double *xs, const double *ys,
+                              const double *zs, size_t num_positions,
+                              double *distances) const;
+
+  TrajectoryClearance CheckTrajectory(const TrajectorySamples &trajectory,
+                                      double safety_distance) const;
+  // clearances[i] is filled for candidates[i]
+  void CheckTrajectories(const std::vector<TrajectorySamples> &candidates,
+                         double safety_distance,
+                         std::vector<TrajectoryClearance> &clearances) const;
+
+private:
+  using VoxelKey = uint64_t;
+  struct VoxelKeyHash {
+    size_t operator()(VoxelKey key) const;
+  };
+  struct Obstacle {
+    TimedPosition position;
+    VoxelKey key{0};
+    bool is_alive{false};
+  };
+
+  double voxel_size_;
+  double max_query_distance_;
+  size_t num_obstacles_{0};
+
+  std::vector<Obstacle> obstacles_; // indexed by ObstacleId
+  std::vector<ObstacleId> free_ids_;
+  std::unordered_map<VoxelKey, std::vector<ObstacleId>, VoxelKeyHash> voxels_;
+
+  DistanceFieldConfig field_config_;
+  double field_truncation_{0.0};
+  std::vector<float> distance_field_; // empty when disabled
+
+  int ToVoxelIndex(double coordinate) const;
+  VoxelKey ToVoxelKey(int ix, int iy, int iz) const;
+  VoxelKey ToVoxelKey(const TimedPosition &position) const;
+  void AddToVoxel(VoxelKey key, ObstacleId id);
+  void RemoveFromVoxel(VoxelKey key, ObstacleId id);
+
+  // saturates at max_distance
+  double QueryIndex(double x, double y, double z, double max_distance) const;
+  // false if (x, y, z) is outside the grid
+  bool QueryField(double x, double y, double z, double &distance) const;
+  size_t ToFieldIndex(int ix, int iy, int iz) const;
+  // visits (x, y, z, squared distance, sample) for the samples within the
+  // truncation distance of position
+  template <typename Visitor>
+  void ForEachFieldSampleNear(const TimedPosition &position,
+                              Visitor &&visitor);
+  void AddToField(const TimedPosition &position);
+  void RemoveFromField(const TimedPosition &position);
 };
 
 } // namespace backend
 } // namespace my_robotics_library
 
-#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_TARGET_PREDICTOR_H_
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_OBSTACLE_MANAGER_H_
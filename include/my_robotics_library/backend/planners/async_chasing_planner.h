@@ -0,0 +1,98 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_ASYNC_CHASING_PLANNER_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_ASYNC_CHASING_PLANNER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+#include "my_robotics_library/backend/planners/chasing_planner.h"
+#include "my_robotics_library/backend/planners/motion_planning_result_store.h"
+
+namespace my_robotics_library {
+namespace backend {
+
+// Runs ChasingPlanner on a worker thread. The worker fills a back buffer;
+// the control thread swaps it with its front buffer in Poll(), so the plan
+// being served is never touched while a new one is computed.
+// Submit() and Poll() must be called from the same (control) thread.
+class AsyncChasingPlanner {
+public:
+  // Submissions whose target moved less than target_tolerance from the job
+  // in flight are dropped instead of restarting the job. The worker holds
+  // planning_mutex, if given, shared while it plans, e.g. to keep the
+  // obstacle map a sampling planner reads from changing underneath it.
+  AsyncChasingPlanner(ChasingPlanner &planner, double target_tolerance,
+                      std::shared_mutex *planning_mutex = nullptr);
+  ~AsyncChasingPlanner();
+
+  AsyncChasingPlanner(const AsyncChasingPlanner &) = delete;
+  AsyncChasingPlanner &operator=(const AsyncChasingPlanner &) = delete;
+
+  // Supersedes any job in flight, whose result will be discarded.
+  // Returns false when the submission was dropped.
+  bool Submit(const ChasingPlannerInput &planner_input);
+
+  // Swaps in the latest completed plan, and releases a superseded or
+  // cancelled one. Returns true if result_store changed. Call every tick,
+  // whatever the phase, so the worker is never left holding a result.
+  bool Poll(MotionPlanningResultStore &result_store);
+
+  // Drops the job in flight, e.g. once chasing was left; its result will
+  // never be swapped in.
+  void Cancel();
+
+  // a plan was submitted and has not been swapped in yet
+  bool IsPending() const { return is_pending_; }
+
+private:
+  ChasingPlanner &planner_;
+  double target_tolerance_;
+  std::shared_mutex *planning_mutex_;
+
+  // control thread only
+  bool is_pending_{false};
+  ChasingPlannerInput pending_input_;
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  // guarded by mutex_
+  bool has_job_{false};
+  bool stop_{false};
+  ChasingPlannerInput job_input_;
+  uint64_t job_generation_{0};
+
+  std::atomic<uint64_t> latest_generation_{0};
+  // owned by the worker while is_ready_ is false, by the control thread after
+  std::atomic<bool> is_ready_{false};
+  MotionPlanningResultStore back_buffer_;
+  uint64_t back_buffer_generation_{0};
+
+  std::thread worker_;
+
+  void Run();
+};
+
+} // namespace backend
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_ASYNC_CHASING_PLANNER_H_
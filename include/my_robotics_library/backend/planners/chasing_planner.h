@@ -19,30 +19,100 @@
 #ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_Chasing_PLANNER_H_
 #define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_Chasing_PLANNER_H_
 
+#include "my_robotics_library/backend/clock.h"
+#include "my_robotics_library/backend/obstacle_manager.h"
+#include "my_robotics_library/backend/thread_pool.h"
 #include "my_robotics_library/backend/types.h"
 
 namespace my_robotics_library {
 namespace backend {
 
+class MotionPlanningResultStore;
+
 struct ChasingPlannerInput {
+  // target state at the planning time. The target is assumed to keep its
+  // velocity over the horizon
   TimedPosition target_position;
+  TimedVelocity target_velocity;
+  TimedPosition robot_position;
+  TimedVelocity robot_velocity;
+  double horizon{1.0};
 };
 
-class ChasingMotionPlanningResult : public MotionPlanningResult {
+// Minimum-jerk quintic per axis from the robot state at t_request to the
+// view position and velocity predicted at the end of the horizon, moving on
+// at that velocity afterwards. Coefficients are fixed at construction so
+// evaluation is a Horner step per axis.
+class ChasingMotionPlanningResult final : public MotionPlanningResult {
 public:
-  ChasingMotionPlanningResult(TimedPosition target_position);
-  Control GenerateControl(double t) const;
-  std::vector<TimedPosition> GetPlanningTrajectory(double t0, double tf) const;
+  ChasingMotionPlanningResult(const TimedPosition &view_position,
+                              const TimedVelocity &view_velocity,
+                              const TimedPosition &robot_position,
+                              const TimedVelocity &robot_velocity,
+                              double horizon, double t_request);
+  Control GenerateControl(double t) const override;
+  void SampleTrajectory(double t0, double dt, size_t num_samples,
+                        TimedPosition *samples) const override;
+  void SampleTrajectory(double t0, double dt,
+                        TrajectorySamples &samples) const override;
+
+  TimedPosition EvaluatePosition(double t) const;
+  // integral of the squared jerk over the horizon
+  double GetJerkCost() const;
 
 private:
+  static constexpr int kNumCoefficients = 6;
   TimedPosition planned_view_position_;
+  TimedVelocity planned_view_velocity_;
+  double horizon_;
+  // ascending powers of the time since t_request, for x, y and z
+  double coefficients_[3][kNumCoefficients];
 };
 
 class ChasingPlanner {
 public:
-  ChasingPlanner() = default;
+  explicit ChasingPlanner(
+      std::shared_ptr<const Clock> clock = GetDefaultClock());
   ChasingMotionPlanningResult
   ComputeChasingMotion(const ChasingPlannerInput &planner_input);
+  // constructs the result directly inside the store
+  const ChasingMotionPlanningResult &
+  ComputeChasingMotion(const ChasingPlannerInput &planner_input,
+                       MotionPlanningResultStore &result_store);
+
+  // Plans to the best of the candidate view positions around the target,
+  // scored in parallel for clearance, visibility and smoothness. The
+  // obstacle manager and the pool must outlive the planner.
+  void EnableSampling(const ChasingSamplingParameter &parameter,
+                      double safety_distance,
+                      const ObstacleManager *obstacle_manager,
+                      ThreadPool *thread_pool);
+  void DisableSampling() { thread_pool_ = nullptr; }
+  bool IsSamplingEnabled() const { return thread_pool_ != nullptr; }
+
+  // where the target is expected at the end of the horizon
+  static TimedPosition
+  PredictViewPosition(const ChasingPlannerInput &planner_input);
+
+private:
+  struct Candidate {
+    TimedPosition view_position;
+    TrajectorySamples trajectory;
+    double cost{0.0};
+  };
+
+  std::shared_ptr<const Clock> clock_;
+
+  ChasingSamplingParameter sampling_parameter_;
+  double safety_distance_{0.0};
+  const ObstacleManager *obstacle_manager_{nullptr};
+  ThreadPool *thread_pool_{nullptr};
+  std::vector<Candidate> candidates_;
+
+  TimedPosition SelectViewPosition(const ChasingPlannerInput &planner_input);
+  double ScoreCandidate(const ChasingPlannerInput &planner_input,
+                        const TimedPosition &target_view,
+                        Candidate &candidate) const;
 };
 
 } // namespace backend
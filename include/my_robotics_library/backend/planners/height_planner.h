@@ -19,37 +19,51 @@
 #ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_Height_PLANNER_H_
 #define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_Height_PLANNER_H_
 
-#include "chrono"
+#include "my_robotics_library/backend/clock.h"
+#include "my_robotics_library/backend/seqlock.h"
 #include "my_robotics_library/backend/types.h"
 
 namespace my_robotics_library {
 namespace backend {
 
+class MotionPlanningResultStore;
+
 struct HeightPlannerInput {
   double target_height{1.0};
 };
 
-class HeightMotionPlanningResult : public MotionPlanningResult {
+class HeightMotionPlanningResult final : public MotionPlanningResult {
 public:
   HeightMotionPlanningResult(double planned_height,
-                             TimedPosition *position_ptr);
-  Control GenerateControl(double t) const;
-  std::vector<TimedPosition> GetPlanningTrajectory(double t0, double tf) const;
+                             const SeqLock<TimedPosition> *position_ptr,
+                             double t_request);
+  Control GenerateControl(double t) const override;
+  void SampleTrajectory(double t0, double dt, size_t num_samples,
+                        TimedPosition *samples) const override;
+  void SampleTrajectory(double t0, double dt,
+                        TrajectorySamples &samples) const override;
 
 private:
   double planned_height_{0.0};
-  TimedPosition *robot_position_ptr_;
+  const SeqLock<TimedPosition> *robot_position_ptr_;
 };
 
 class HeightPlanner {
 public:
-  HeightPlanner() = default;
+  explicit HeightPlanner(
+      std::shared_ptr<const Clock> clock = GetDefaultClock());
+  // safe to call from a sensor thread while results are being evaluated
   void SetRobotPosition(const TimedPosition &robot_position);
   HeightMotionPlanningResult
   ComputeHeightMotion(const HeightPlannerInput &planner_input);
+  // constructs the result directly inside the store
+  const HeightMotionPlanningResult &
+  ComputeHeightMotion(const HeightPlannerInput &planner_input,
+                      MotionPlanningResultStore &result_store);
 
 private:
-  TimedPosition robot_position_;
+  std::shared_ptr<const Clock> clock_;
+  SeqLock<TimedPosition> robot_position_;
 };
 
 } // namespace backend
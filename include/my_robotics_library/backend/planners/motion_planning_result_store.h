@@ -0,0 +1,62 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_MOTION_PLANNING_RESULT_STORE_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_MOTION_PLANNING_RESULT_STORE_H_
+
+#include <utility>
+#include <variant>
+
+#include "my_robotics_library/backend/planners/chasing_planner.h"
+#include "my_robotics_library/backend/planners/height_planner.h"
+
+namespace my_robotics_library {
+namespace backend {
+
+// Fixed-footprint slot for the result of any planner. Results are constructed
+// in place, so replacing a plan never touches the heap.
+class MotionPlanningResultStore {
+public:
+  MotionPlanningResultStore() = default;
+
+  template <typename Result, typename... Args> Result &Emplace(Args &&...args) {
+    return result_.emplace<Result>(std::forward<Args>(args)...);
+  }
+  void Reset() { result_.emplace<std::monostate>(); }
+  bool HasValue() const {
+    return !std::holds_alternative<std::monostate>(result_);
+  }
+
+  // nullptr when empty
+  const MotionPlanningResult *Get() const;
+
+  // Dispatches on the stored alternative without going through the vtable.
+  // Requires HasValue()
+  Control GenerateControl(double t) const;
+  void SampleTrajectory(double t0, double dt, TrajectorySamples &samples) const;
+
+private:
+  std::variant<std::monostate, HeightMotionPlanningResult,
+               ChasingMotionPlanningResult>
+      result_;
+};
+
+} // namespace backend
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_MOTION_PLANNING_RESULT_STORE_H_
@@ -0,0 +1,105 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_POINT_CLOUD_INGESTOR_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_POINT_CLOUD_INGESTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "my_robotics_library/backend/obstacle_manager.h"
+#include "my_robotics_library/backend/thread_pool.h"
+#include "my_robotics_library/backend/types.h"
+
+namespace my_robotics_library {
+
+// Non-owning view of float x, y, z triplets, stride bytes apart, e.g. a
+// packed array or the leading fields of larger point structs.
+struct PointCloudView {
+  const float *xyz{nullptr};
+  size_t num_points{0};
+  size_t stride{3 * sizeof(float)};
+
+  const float *GetPoint(size_t index) const {
+    return reinterpret_cast<const float *>(
+        reinterpret_cast<const char *>(xyz) + index * stride);
+  }
+};
+
+namespace backend {
+
+// Keeps a sliding window of depth observations in an obstacle map. A frame
+// is ingested in two steps so callers can guard the map only while it is
+// written:
+//  1. Downsample reads the points in parallel and reduces them to the
+//     sorted set of occupied voxels. It does not touch the map.
+//  2. MergeSlice inserts newly occupied voxels, refreshes the ones seen
+//     again and removes the ones unseen for longer than the window, a slice
+//     at a time.
+// Downsampling reuses its buffers across frames. Use from one thread at a
+// time.
+class PointCloudIngestor {
+public:
+  PointCloudIngestor(ObstacleManager &obstacle_manager,
+                     const PointCloudParameter &parameter,
+                     ThreadPool &thread_pool = GetDefaultThreadPool());
+
+  // returns the number of occupied voxels. Non-finite points are skipped
+  size_t Downsample(const PointCloudView &cloud);
+  // Merges up to parameter.merge_slice voxels of the last downsampled frame
+  // observed at time t, then expires as many stale ones. Returns true once
+  // the frame is fully merged.
+  bool MergeSlice(double t);
+  // both steps at once
+  void Ingest(const PointCloudView &cloud, double t);
+
+  size_t GetNumObservedVoxels() const { return observations_.size(); }
+
+private:
+  struct Observation {
+    ObstacleId id{0};
+    double last_seen{0.0};
+  };
+
+  ObstacleManager &obstacle_manager_;
+  PointCloudParameter parameter_;
+  ThreadPool &thread_pool_;
+
+  std::vector<uint64_t> keys_; // occupied voxels of the last frame
+  std::vector<uint64_t> merge_buffer_;
+  size_t num_keys_{0};
+  size_t num_merged_{0};
+  // chunk c holds its sorted unique keys in [chunk_bounds_[c], [c + 1])
+  std::vector<size_t> chunk_bounds_;
+  std::unordered_map<uint64_t, Observation> observations_;
+  // (time seen, voxel) in time order; entries refreshed later are skipped
+  std::deque<std::pair<double, uint64_t>> expiry_queue_;
+
+  uint64_t ToKey(const float *point) const;
+  TimedPosition ToCenter(uint64_t key, double t) const;
+};
+
+} // namespace backend
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_POINT_CLOUD_INGESTOR_H_
@@ -0,0 +1,124 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_SEQLOCK_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_SEQLOCK_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace my_robotics_library {
+
+// Sequence lock publishing a trivially copyable value. Readers never block
+// writers and never take a lock: they retry only if a write overlapped the
+// copy. Concurrent writers are serialized among themselves by spinning on
+// the sequence, so keep writes short (a copy and a field assignment).
+template <typename T> class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock requires a trivially copyable type");
+
+public:
+  SeqLock() : SeqLock(T()) {}
+  explicit SeqLock(const T &value) { WriteWords(value); }
+
+  SeqLock(const SeqLock &) = delete;
+  SeqLock &operator=(const SeqLock &) = delete;
+
+  T Load() const {
+    T value;
+    while (true) {
+      uint64_t sequence_begin = sequence_.load(std::memory_order_acquire);
+      if (sequence_begin & 1) {
+        std::this_thread::yield();
+        continue;
+      }
+      ReadWords(value);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == sequence_begin)
+        return value;
+    }
+  }
+
+  void Store(const T &value) {
+    uint64_t sequence = LockWriter();
+    WriteWords(value);
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  // Read-modify-write of the published value, e.g. to set a single field.
+  template <typename Mutator> void Update(Mutator &&mutate) {
+    uint64_t sequence = LockWriter();
+    T value;
+    ReadWords(value);
+    mutate(value);
+    WriteWords(value);
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  // number of completed writes
+  uint64_t GetVersion() const {
+    return sequence_.load(std::memory_order_acquire) / 2;
+  }
+
+private:
+  static constexpr size_t kNumWords =
+      (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  std::atomic<uint64_t> sequence_{0};
+  std::array<std::atomic<uint64_t>, kNumWords> words_;
+
+  // returns the (even) sequence observed before taking the writer slot
+  uint64_t LockWriter() {
+    uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    while (true) {
+      if (sequence & 1) {
+        std::this_thread::yield();
+        sequence = sequence_.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (sequence_.compare_exchange_weak(sequence, sequence + 1,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed))
+        break;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    return sequence;
+  }
+
+  void ReadWords(T &value) const {
+    uint64_t buffer[kNumWords];
+    for (size_t n = 0; n < kNumWords; n++)
+      buffer[n] = words_[n].load(std::memory_order_relaxed);
+    std::memcpy(&value, buffer, sizeof(T));
+  }
+
+  void WriteWords(const T &value) {
+    uint64_t buffer[kNumWords] = {};
+    std::memcpy(buffer, &value, sizeof(T));
+    for (size_t n = 0; n < kNumWords; n++)
+      words_[n].store(buffer[n], std::memory_order_relaxed);
+  }
+};
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_SEQLOCK_H_
@@ -0,0 +1,88 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_SPSC_RING_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_SPSC_RING_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace my_robotics_library {
+
+// Bounded lock-free queue between exactly one producer thread and one
+// consumer thread. Head and tail sit on separate cache lines, and each side
+// caches the other's index so the shared line is only read when the ring
+// looks full or empty.
+template <typename T, size_t Capacity> class SpscRing {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "SpscRing capacity must be a power of two");
+
+public:
+  SpscRing() = default;
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  // producer side; false if full
+  bool TryPush(const T &value) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ == Capacity) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ == Capacity)
+        return false;
+    }
+    slots_[tail & (Capacity - 1)] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer side; false if empty
+  bool TryPop(T &value) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_)
+        return false;
+    }
+    value = slots_[head & (Capacity - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // approximate unless called from one of the two threads while the other
+  // is idle
+  size_t Size() const {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+  static constexpr size_t GetCapacity() { return Capacity; }
+
+private:
+  alignas(64) std::atomic<uint64_t> head_{0};
+  uint64_t cached_tail_{0}; // consumer only
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  uint64_t cached_head_{0}; // producer only
+  alignas(64) std::array<T, Capacity> slots_{};
+};
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_SPSC_RING_H_
@@ -0,0 +1,78 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_TARGET_PREDICTOR_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_TARGET_PREDICTOR_H_
+
+#include "my_robotics_library/backend/types.h"
+
+namespace my_robotics_library {
+namespace backend {
+
+struct TargetPredictorParameter {
+  // white acceleration noise density [m^2/s^3]
+  double process_noise{0.5};
+  // detection noise variance [m^2]
+  double measurement_noise{0.01};
+  double initial_velocity_variance{4.0};
+  // without a detection for this long, the track is dropped
+  double lost_timeout{1.0};
+};
+
+// Constant-velocity Kalman filter on the target, one decoupled 2-state
+// filter per axis. Detection time stamps (TimedPosition::t) drive the filter;
+// gaps in detections simply widen the prediction until lost_timeout.
+class TargetPredictor {
+public:
+  explicit TargetPredictor(
+      const TargetPredictorParameter &parameter = TargetPredictorParameter());
+
+  // Detections older than the last one are ignored
+  void AddDetection(const TimedPosition &detection);
+  void Reset() { is_initialized_ = false; }
+
+  // A track exists and was detected within lost_timeout of t, before or
+  // after it. A track stamped on another time base has no estimate, so it
+  // is never extrapolated across the offset.
+  bool HasEstimate(double t) const;
+  TimedPosition PredictPosition(double t) const;
+  TimedVelocity GetVelocity() const;
+  // position variance of the prediction at t, per axis
+  TimedPosition GetPositionVariance(double t) const;
+
+private:
+  struct AxisState {
+    double position{0.0};
+    double velocity{0.0};
+    double covariance[2][2]{{0.0, 0.0}, {0.0, 0.0}};
+  };
+
+  TargetPredictorParameter parameter_;
+  bool is_initialized_{false};
+  double t_last_detection_{0.0};
+  AxisState axes_[3];
+
+  void Initialize(const TimedPosition &detection);
+  void PredictAxis(AxisState &axis, double dt) const;
+  void CorrectAxis(AxisState &axis, double measurement) const;
+};
+
+} // namespace backend
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_TARGET_PREDICTOR_H_
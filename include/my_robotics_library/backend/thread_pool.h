@@ -0,0 +1,120 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_THREAD_POOL_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_THREAD_POOL_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace my_robotics_library {
+
+// Persistent pool of workers, each with its own task deque. A worker pops
+// from the back of its own deque and steals from the front of the others'.
+// Ranges are split in halves on the fly, so idle workers steal large chunks
+// first. ParallelFor does not allocate and may be nested: a waiting caller
+// runs pending tasks itself.
+class ThreadPool {
+public:
+  // num_threads counts the calling thread, so 1 runs everything inline
+  explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t GetNumThreads() const { return workers_.size() + 1; }
+
+  // Calls function(index) for every index in [begin, end). Ranges no longer
+  // than grain run on a single thread.
+  template <typename Function>
+  void ParallelFor(size_t begin, size_t end, size_t grain,
+                   Function &&function) {
+    if (begin >= end)
+      return;
+    Job job;
+    job.context = &function;
+    job.invoke = [](void *context, size_t range_begin, size_t range_end) {
+      auto &callable = *static_cast<std::remove_reference_t<Function> *>(
+          context);
+      for (size_t index = range_begin; index < range_end; index++)
+        callable(index);
+    };
+    job.grain = std::max<size_t>(grain, 1);
+    job.remaining.store(end - begin, std::memory_order_relaxed);
+    Run(job, begin, end);
+  }
+
+private:
+  struct Job {
+    void (*invoke)(void *, size_t, size_t){nullptr};
+    void *context{nullptr};
+    size_t grain{1};
+    std::atomic<size_t> remaining{0};
+  };
+  struct Task {
+    Job *job{nullptr};
+    size_t begin{0};
+    size_t end{0};
+  };
+  // Fixed-capacity deque. When full, the owner runs the task inline.
+  struct TaskQueue {
+    static constexpr size_t kCapacity = 256;
+    std::mutex mutex;
+    std::array<Task, kCapacity> tasks;
+    size_t head{0};
+    size_t size{0};
+
+    bool PushBack(const Task &task);
+    bool PopBack(Task &task);
+    bool PopFront(Task &task);
+  };
+
+  std::vector<std::thread> workers_;
+  // one queue per worker plus one shared by external callers
+  std::unique_ptr<TaskQueue[]> queues_;
+  size_t num_queues_{0};
+
+  std::atomic<bool> stop_{false};
+  std::atomic<size_t> num_queued_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_condition_;
+
+  void Run(Job &job, size_t begin, size_t end);
+  void WorkerLoop(size_t worker_index);
+  size_t GetLocalQueueIndex() const;
+  bool TryPop(size_t queue_index, Task &task);
+  void Execute(size_t queue_index, Task task);
+  void Push(size_t queue_index, const Task &task);
+};
+
+// Process-wide pool sized to the hardware, created on first use
+ThreadPool &GetDefaultThreadPool();
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_THREAD_POOL_H_
@@ -0,0 +1,77 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_TRIPLE_BUFFER_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_TRIPLE_BUFFER_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace my_robotics_library {
+
+// Hands the latest value from one writer thread to one reader thread. The
+// writer fills a back buffer and swaps it with the middle one; the reader
+// swaps the middle one with its front buffer when it holds a newer value.
+// Neither side waits, and unlike a SeqLock the value need not be trivially
+// copyable. Intermediate values may be skipped.
+template <typename T> class TripleBuffer {
+public:
+  TripleBuffer() = default;
+
+  TripleBuffer(const TripleBuffer &) = delete;
+  TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+  // writer side
+  T &GetBackBuffer() { return buffers_[back_]; }
+  void Publish() {
+    uint8_t previous =
+        middle_.exchange(back_ | kFreshBit, std::memory_order_acq_rel);
+    back_ = previous & kIndexMask;
+  }
+  void Write(const T &value) {
+    GetBackBuffer() = value;
+    Publish();
+  }
+
+  // reader side. The reference stays valid until the next Read
+  const T &Read() {
+    if (middle_.load(std::memory_order_relaxed) & kFreshBit) {
+      uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+      front_ = previous & kIndexMask;
+    }
+    return buffers_[front_];
+  }
+  bool HasUpdate() const {
+    return middle_.load(std::memory_order_relaxed) & kFreshBit;
+  }
+
+private:
+  static constexpr uint8_t kIndexMask = 0x3;
+  static constexpr uint8_t kFreshBit = 0x4;
+
+  std::array<T, 3> buffers_{};
+  uint8_t back_{0};  // writer only
+  uint8_t front_{1}; // reader only
+  std::atomic<uint8_t> middle_{2};
+};
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_CORE_TRIPLE_BUFFER_H_
@@ -18,11 +18,65 @@
 
 #ifndef SIMPLE_ROBOTICS_FRONTEND_TYPES_H
 #define SIMPLE_ROBOTICS_FRONTEND_TYPES_H
+#include <cstddef>
 #include <vector>
 namespace my_robotics_library {
 
+// Candidate view positions for sampling-based chasing sit on a grid of
+// azimuth x elevation x distance around the predicted target.
+struct ChasingSamplingParameter {
+  int num_azimuths{16};
+  int num_elevations{3};
+  int num_distances{4};
+  double min_view_distance{1.0};
+  double max_view_distance{3.0};
+  double max_elevation{0.8}; // [rad]
+  double desired_view_distance{2.0};
+  int num_trajectory_samples{20};
+  // line of sight closer than this to an obstacle counts as occluded
+  double occlusion_radius{0.3};
+
+  double smoothness_weight{0.01};
+  double visibility_weight{1.0};
+  double clearance_weight{0.5};
+  double occlusion_weight{100.0};
+};
+
+// Depth frames are voxel-downsampled before they enter the obstacle map, one
+// obstacle per occupied voxel.
+struct PointCloudParameter {
+  double voxel_size{0.2};
+  // voxels not observed again for this long are removed [s]
+  double window{1.0};
+  // voxels merged per hold of the obstacle lock
+  size_t merge_slice{4096};
+};
+
 struct Parameter {
   double hovering_height{1.0};
+  // closer than this to an obstacle triggers a hold-stop
+  double safety_distance{1.0};
+  // the active plan is checked for clearance over this look-ahead [s]
+  double safety_check_horizon{1.0};
+  int safety_check_num_samples{30};
+  double chasing_replan_period{0.2};
+  // transitions handled per tick or command before the rest is deferred
+  int max_events_per_tick{4};
+  // duration of the chasing trajectory towards the view position [s]
+  double chasing_horizon{1.0};
+  // Aim chasing plans at the predicted rather than the last seen target.
+  // Target stamps must share the time base of the Wrapper's clock; a target
+  // detected more than TargetPredictorParameter::lost_timeout away from the
+  // clock is chased where it was last seen.
+  bool use_target_prediction{true};
+  // score sampled view positions in parallel instead of aiming at the target
+  bool use_sampling_chasing_planner{false};
+  ChasingSamplingParameter chasing_sampling;
+  // plan chasing motion on a worker thread instead of inside the timer tick
+  bool use_async_chasing_planner{false};
+  // target displacement that restarts an async chasing plan in flight
+  double async_replan_target_tolerance{0.05};
+  PointCloudParameter point_cloud;
 };
 
 enum MotionPhase {
@@ -33,6 +87,7 @@ enum MotionPhase {
   kHovering,
   kIdle
 };
+constexpr size_t kNumMotionPhases = MotionPhase::kIdle + 1;
 
 struct TimedPosition {
   double t{0.0};
@@ -48,6 +103,32 @@ struct TimedVelocity {
   double z{0.0};
 };
 
+// Trajectory samples in structure-of-arrays layout for batch processing.
+// Resize() once up front and reuse the buffer to avoid allocation.
+struct TrajectorySamples {
+  std::vector<double> t;
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> z;
+
+  size_t Size() const { return t.size(); }
+  void Resize(size_t size) {
+    t.resize(size);
+    x.resize(size);
+    y.resize(size);
+    z.resize(size);
+  }
+  void Assign(const std::vector<TimedPosition> &trajectory) {
+    Resize(trajectory.size());
+    for (size_t n = 0; n < trajectory.size(); n++) {
+      t[n] = trajectory[n].t;
+      x[n] = trajectory[n].x;
+      y[n] = trajectory[n].y;
+      z[n] = trajectory[n].z;
+    }
+  }
+};
+
 struct Control {
   MotionPhase phase{kIdle};
   double t{0.0};
@@ -59,9 +140,24 @@ class MotionPlanningResult {
 public:
   MotionPlanningResult(MotionPhase motion_phase, double t_request)
       : motion_type_(motion_phase), t_request_(t_request){};
+  static constexpr size_t kDefaultNumSamples = 30;
+
   virtual Control GenerateControl(double t) const = 0;
-  virtual std::vector<TimedPosition> GetPlanningTrajectory(double t0,
-                                                           double tf) const = 0;
+  // Write num_samples samples at t0, t0 + dt, ... into caller-owned storage
+  virtual void SampleTrajectory(double t0, double dt, size_t num_samples,
+                                TimedPosition *samples) const = 0;
+  // Fills all samples.Size() entries
+  virtual void SampleTrajectory(double t0, double dt,
+                                TrajectorySamples &samples) const = 0;
+
+  // kDefaultNumSamples samples over [t0, tf). Allocates; prefer
+  // SampleTrajectory on hot paths
+  std::vector<TimedPosition> GetPlanningTrajectory(double t0, double tf) const {
+    std::vector<TimedPosition> trajectory(kDefaultNumSamples);
+    SampleTrajectory(t0, (tf - t0) / kDefaultNumSamples, kDefaultNumSamples,
+                     trajectory.data());
+    return trajectory;
+  }
   MotionPhase GetMotionType() const { return motion_type_; };
   double GetRequestTime() const { return t_request_; }
 
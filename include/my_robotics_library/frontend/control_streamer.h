@@ -0,0 +1,109 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_CONTROL_STREAMER_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_CONTROL_STREAMER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "my_robotics_library/backend/clock.h"
+#include "my_robotics_library/backend/planners/motion_planning_result_store.h"
+#include "my_robotics_library/backend/spsc_ring.h"
+#include "my_robotics_library/backend/triple_buffer.h"
+#include "my_robotics_library/backend/types.h"
+
+namespace my_robotics_library {
+
+// Control of the phase at time t, always stamped with phase. Phases without
+// a plan of their own (idle, holding, exploration) command zero, and so
+// does a phase whose plan is not served yet, e.g. while an async chasing
+// plan is pending; the others follow plan.
+Control GenerateControl(MotionPhase phase,
+                        const backend::MotionPlanningResultStore &plan,
+                        double t);
+
+struct ControlStreamerOptions {
+  double frequency{1000.0}; // [Hz]
+  // one ring per actuator thread
+  size_t num_consumers{1};
+};
+
+// Streams Control samples at a high fixed rate between planning ticks. The
+// control thread publishes the phase and plan after every tick through a
+// triple buffer; the streaming thread evaluates the latest one at the
+// current time and pushes the sample into a lock-free ring per consumer.
+// Neither thread waits on the other.
+class ControlStreamer {
+public:
+  static constexpr size_t kRingCapacity = 256;
+  using ControlRing = SpscRing<Control, kRingCapacity>;
+
+  explicit ControlStreamer(
+      const ControlStreamerOptions &options = ControlStreamerOptions(),
+      std::shared_ptr<const Clock> clock = GetDefaultClock());
+  ~ControlStreamer();
+
+  ControlStreamer(const ControlStreamer &) = delete;
+  ControlStreamer &operator=(const ControlStreamer &) = delete;
+
+  // from the control thread, see Wrapper::SetControlStreamer
+  void Publish(MotionPhase phase,
+               const backend::MotionPlanningResultStore &plan);
+
+  // Samples on a new thread at options.frequency until Stop
+  bool Start();
+  void Stop();
+  bool IsRunning() const { return thread_.joinable(); }
+
+  // Evaluates the latest plan at the current time and pushes the sample to
+  // every ring. The streaming thread's work; call it directly instead of
+  // Start to sample from a timer of your own.
+  Control Step();
+
+  size_t GetNumConsumers() const { return options_.num_consumers; }
+  // each ring is drained by exactly one thread
+  ControlRing &GetRing(size_t consumer) { return rings_[consumer]; }
+
+  uint64_t GetNumSamples() const { return num_samples_.load(); }
+  // sample copies not delivered because a ring was full
+  uint64_t GetNumDropped() const { return num_dropped_.load(); }
+
+private:
+  struct Snapshot {
+    MotionPhase phase{MotionPhase::kIdle};
+    backend::MotionPlanningResultStore plan;
+  };
+
+  ControlStreamerOptions options_;
+  std::shared_ptr<const Clock> clock_;
+  TripleBuffer<Snapshot> snapshots_;
+  std::unique_ptr<ControlRing[]> rings_;
+  std::thread thread_;
+  std::atomic<bool> stop_{false};
+  std::atomic<uint64_t> num_samples_{0};
+  std::atomic<uint64_t> num_dropped_{0};
+};
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_CONTROL_STREAMER_H_
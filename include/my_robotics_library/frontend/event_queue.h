@@ -0,0 +1,56 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_EVENT_QUEUE_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_EVENT_QUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "my_robotics_library/frontend/monitor.h"
+
+namespace my_robotics_library {
+
+// Pending events as one bit per MonitorEvent. Posting the same event twice
+// before it is handled coalesces into one, and the order of handling is
+// decided by priority when draining, not by arrival. Safe to post from any
+// thread.
+class EventQueue {
+  static_assert(kNumMonitorEvents <= 32, "events must fit in the mask");
+
+public:
+  void Post(MonitorEvent event) {
+    events_.fetch_or(1u << event, std::memory_order_release);
+  }
+  // puts back events that could not be handled yet
+  void Restore(uint32_t events) {
+    events_.fetch_or(events, std::memory_order_release);
+  }
+  uint32_t TakeAll() { return events_.exchange(0, std::memory_order_acquire); }
+  bool IsEmpty() const {
+    return events_.load(std::memory_order_relaxed) == 0;
+  }
+
+private:
+  std::atomic<uint32_t> events_{0};
+};
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_EVENT_QUEUE_H_
@@ -0,0 +1,166 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_FLIGHT_RECORDER_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_FLIGHT_RECORDER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "my_robotics_library/backend/types.h"
+#include "my_robotics_library/frontend/monitor.h"
+
+namespace my_robotics_library {
+
+struct SensorInformation;
+
+enum class FlightRecordType : uint32_t {
+  kEmpty = 0, // slot reserved but not yet written
+  kTimerTick,
+  kHoveringCommand,
+  kChasingCommand,
+  kSensor, // snapshot the following callback ran on
+  kMonitorEvent,
+  kTransition,
+  kControl,
+  // SetPosition call; the plans read the latest position when controlling
+  kPosition,
+  // commands queued for the next tick
+  kPostedHoveringCommand,
+  kPostedChasingCommand
+};
+
+// Fixed 120-byte record. A tick or command record is followed by the sensor
+// snapshot it read, then by the events, transitions and controls it caused.
+// Position and posted command records of other threads may land in between.
+struct FlightRecord {
+  std::atomic<uint32_t> type; // written last, see GetType()
+  // kMonitorEvent: MonitorEvent, kTransition: new MotionPhase,
+  // kControl: MotionPhase, kSensor: battery level
+  int32_t value;
+  // kTransition: previous MotionPhase, kSensor: 1 if a target is detected
+  int32_t previous;
+  uint32_t reserved;
+  double t; // clock time of the record
+  // kSensor: velocity, position and target as (t, x, y, z)
+  // kControl: control t and input, kPosition: (t, x, y, z)
+  double data[12];
+
+  FlightRecordType GetType() const {
+    return static_cast<FlightRecordType>(
+        type.load(std::memory_order_acquire));
+  }
+};
+
+struct FlightLogHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint64_t capacity;
+  std::atomic<uint64_t> num_reserved;
+  std::atomic<uint64_t> num_dropped;
+  uint64_t padding[3];
+};
+
+// Appends records to a preallocated, memory-mapped file. Appending reserves
+// a slot with a single fetch_add and writes it in place, so recording never
+// blocks on I/O or a lock and may be shared by several threads. Once the
+// file is full, further records are counted as dropped.
+class FlightRecorder {
+public:
+  FlightRecorder() = default;
+  ~FlightRecorder() { Close(); }
+
+  FlightRecorder(const FlightRecorder &) = delete;
+  FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+  // Creates (or truncates) the file and maps space for capacity records,
+  // e.g. 100 Hz x 5 records x 4 h = 7.2M records (~860 MB).
+  bool Open(const std::string &path, size_t capacity);
+  // same, backed by anonymous memory instead of a file
+  bool OpenInMemory(size_t capacity);
+  // shrinks the file to the records written. Recording must have stopped
+  void Close();
+  bool IsOpen() const { return header_ != nullptr; }
+
+  size_t GetNumRecords() const;
+  size_t GetNumDropped() const;
+  // Requires index < GetNumRecords() and the record to be committed
+  const FlightRecord &operator[](size_t index) const {
+    return records_[index];
+  }
+
+  void RecordTimerTick(double t);
+  void RecordCommand(FlightRecordType command, double t);
+  void RecordSensor(double t, const SensorInformation &sensor);
+  void RecordMonitorEvent(double t, MonitorEvent event);
+  void RecordTransition(double t, MotionPhase from, MotionPhase to);
+  void RecordControl(double t, const Control &control);
+  void RecordPosition(double t, const TimedPosition &position);
+
+private:
+  int file_descriptor_{-1};
+  size_t mapped_size_{0};
+  FlightLogHeader *header_{nullptr};
+  FlightRecord *records_{nullptr};
+
+  bool Map(int file_descriptor, size_t capacity);
+  // nullptr when full
+  FlightRecord *Reserve(double t);
+  static void Commit(FlightRecord &record, FlightRecordType type);
+};
+
+// Read-only view of a log; records are accessed in place without copying.
+// Stops at the first slot that was reserved but never written.
+class FlightLogReader {
+public:
+  FlightLogReader() = default;
+  ~FlightLogReader() { Close(); }
+
+  FlightLogReader(const FlightLogReader &) = delete;
+  FlightLogReader &operator=(const FlightLogReader &) = delete;
+
+  bool Open(const std::string &path);
+  void Close();
+
+  size_t Size() const { return num_records_; }
+  size_t GetNumDropped() const;
+  const FlightRecord &operator[](size_t index) const {
+    return records_[index];
+  }
+  const FlightRecord *begin() const { return records_; }
+  const FlightRecord *end() const { return records_ + num_records_; }
+
+private:
+  void *mapped_{nullptr};
+  size_t mapped_size_{0};
+  const FlightLogHeader *header_{nullptr};
+  const FlightRecord *records_{nullptr};
+  size_t num_records_{0};
+};
+
+// Decoders for kSensor and kControl records
+SensorInformation ToSensorInformation(const FlightRecord &record);
+Control ToControl(const FlightRecord &record);
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_FLIGHT_RECORDER_H_
@@ -0,0 +1,136 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_LOOP_RUNNER_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_LOOP_RUNNER_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "my_robotics_library/backend/seqlock.h"
+#include "my_robotics_library/frontend/wrapper.h"
+
+namespace my_robotics_library {
+
+// deadlines of fixed-rate loops are kept on the monotonic clock
+int64_t GetMonotonicNanoseconds();
+void SleepUntilMonotonic(int64_t deadline_ns);
+
+// Durations in power-of-two buckets: bucket b counts [2^(b-1), 2^b) ns,
+// bucket 0 counts zero.
+class DurationHistogram {
+public:
+  static constexpr size_t kNumBuckets = 40;
+
+  void Add(uint64_t duration_ns);
+
+  uint64_t GetNumSamples() const { return num_samples_; }
+  uint64_t GetMax() const { return max_ns_; }
+  uint64_t GetBucketCount(size_t bucket) const { return buckets_[bucket]; }
+  // upper edge of the bucket holding the quantile, 0 without samples
+  uint64_t GetQuantile(double quantile) const;
+
+private:
+  std::array<uint64_t, kNumBuckets> buckets_{};
+  uint64_t num_samples_{0};
+  uint64_t max_ns_{0};
+};
+
+enum class DegradePolicy : uint8_t {
+  kNone,
+  // Wrapper::SetDegraded for ticks after one that ate into the deadline
+  kSkipLookahead,
+};
+
+struct LoopRunnerOptions {
+  double frequency{100.0}; // [Hz]
+  // CPU to pin the loop thread to; negative leaves it unpinned
+  int cpu{-1};
+  // SCHED_FIFO priority of the loop thread; 0 keeps the default policy
+  int realtime_priority{0};
+  DegradePolicy degrade_policy{DegradePolicy::kSkipLookahead};
+  // a tick that ends later than this fraction of the period after its
+  // deadline degrades the following ticks, until one ends within half of it
+  double degrade_threshold{0.8};
+};
+
+struct LoopStatistics {
+  uint64_t num_ticks{0};
+  // ticks that ended after the next deadline
+  uint64_t num_overruns{0};
+  // deadlines dropped after an overrun instead of ticking in a burst
+  uint64_t num_skipped_periods{0};
+  uint64_t num_degraded_ticks{0};
+  DurationHistogram jitter;    // wake-up after the deadline
+  DurationHistogram execution; // OnTimerCallback, GetControl and the sink
+};
+
+// Drives Wrapper::OnTimerCallback and GetControl at a fixed rate. Each tick
+// sleeps until an absolute deadline on the monotonic clock, so the period
+// does not drift with the work done. After an overrun the missed deadlines
+// are skipped rather than caught up. The runner's thread is the wrapper's
+// control thread.
+class LoopRunner {
+public:
+  using ControlSink = std::function<void(const Control &)>;
+
+  LoopRunner(Wrapper &wrapper, const LoopRunnerOptions &options,
+             ControlSink control_sink = nullptr);
+  ~LoopRunner();
+
+  LoopRunner(const LoopRunner &) = delete;
+  LoopRunner &operator=(const LoopRunner &) = delete;
+
+  // Runs the loop on a new thread until Stop. False if already running
+  bool Start();
+  void Stop();
+  bool IsRunning() const { return thread_.joinable(); }
+  // Runs num_ticks on the calling thread, which is pinned and prioritized
+  // like the loop thread
+  void RunFor(size_t num_ticks);
+
+  // whether pinning and the real-time priority took effect; either may be
+  // refused for lack of permission
+  bool IsPinned() const { return is_pinned_.load(); }
+  bool IsRealtime() const { return is_realtime_.load(); }
+
+  // may be read while running; published once per tick
+  LoopStatistics GetStatistics() const { return statistics_.Load(); }
+
+private:
+  Wrapper &wrapper_;
+  LoopRunnerOptions options_;
+  ControlSink control_sink_;
+  std::thread thread_;
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> is_pinned_{false};
+  std::atomic<bool> is_realtime_{false};
+  SeqLock<LoopStatistics> statistics_;
+
+  void ConfigureThread();
+  void Loop(size_t num_ticks);
+};
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_LOOP_RUNNER_H_
@@ -0,0 +1,105 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_MISSION_SIMULATOR_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_MISSION_SIMULATOR_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "my_robotics_library/backend/thread_pool.h"
+#include "my_robotics_library/backend/types.h"
+
+namespace my_robotics_library {
+
+// Randomized mission of one episode. Ranges are sampled uniformly per
+// episode.
+struct MissionScenario {
+  double duration{60.0};     // [s]
+  double tick_period{0.01};  // [s]
+  double chase_command_time{2.0}; // after the hover command at t = 0
+
+  // vehicle model
+  double max_speed{2.0};     // [m/s]
+  double position_gain{2.0}; // [1/s] towards the chasing set point
+  double landing_speed{0.5}; // [m/s]
+
+  // battery charge runs from 100 to 0 percent
+  double min_battery_drain{0.5}; // [%/s]
+  double max_battery_drain{3.0};
+
+  // target walking on a straight line from in front of the vehicle
+  double min_target_distance{2.0};
+  double max_target_distance{6.0};
+  double max_target_speed{1.0};
+  double sensing_range{8.0};
+  // chance of missing the target on a tick while in range
+  double detection_dropout{0.02};
+
+  // obstacles scattered in a box along the direction of travel
+  int min_num_obstacles{0};
+  int max_num_obstacles{20};
+  double obstacle_field_length{30.0};
+  double obstacle_field_width{6.0};
+  double obstacle_field_height{3.0};
+};
+
+struct MissionSimulatorOptions {
+  Parameter parameter;
+  MissionScenario scenario;
+  // episode n draws from a generator seeded with (seed, n), so results do
+  // not depend on the number of threads
+  uint64_t seed{0};
+};
+
+struct EpisodeResult {
+  std::array<double, kNumMotionPhases> time_in_phase{}; // [s]
+  bool has_landed{false};
+  double flight_time{0.0}; // until touchdown or the end of the mission
+  int num_hold_stops{0};
+  int num_target_losses{0}; // chasing -> exploration
+  int num_chasing_plans{0}; // transitions into chasing, replans included
+};
+
+struct MissionStatistics {
+  size_t num_episodes{0};
+  std::array<double, kNumMotionPhases> mean_time_in_phase{};
+  double landing_rate{0.0}; // fraction of episodes that touched down
+  double mean_flight_time{0.0};
+  double mean_hold_stops{0.0};
+  double mean_target_losses{0.0};
+  double mean_chasing_plans{0.0};
+  double hold_stop_rate{0.0}; // fraction with at least one hold-stop
+};
+
+// Flies one episode: a Wrapper on a simulated clock, driven by its own
+// controls through a kinematic vehicle model. The tick loop does not
+// allocate; the wrapper and obstacle map are built once per episode.
+EpisodeResult SimulateEpisode(const MissionSimulatorOptions &options,
+                              uint64_t episode);
+
+// Runs episodes [0, num_episodes) on the pool and aggregates them in order
+MissionStatistics
+SimulateMissions(const MissionSimulatorOptions &options, size_t num_episodes,
+                 ThreadPool &thread_pool = GetDefaultThreadPool());
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_MISSION_SIMULATOR_H_
@@ -0,0 +1,61 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_MONITOR_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_MONITOR_H_
+
+#include <cstddef>
+
+#include "my_robotics_library/backend/types.h"
+
+namespace my_robotics_library {
+
+struct Monitor {
+  bool is_planning_visible{false};
+  bool is_safe_for_short_horizon{true};
+  bool is_battery_enough{true};
+};
+
+// kHoverCommand and kChaseCommand only fire when posted by a command; the
+// others fire whenever their guard holds.
+enum MonitorEvent {
+  kHover,
+  kLand,
+  kHoldStop,
+  kExplore,
+  kChaseReplan,
+  kHoverCommand,
+  kChaseCommand,
+  kNone
+};
+constexpr size_t kNumMonitorEvents = MonitorEvent::kNone + 1;
+
+// Monitor checks shared by Wrapper and WrapperFleet
+
+// the target only matters while chasing or exploring
+constexpr bool IsPlanningVisible(MotionPhase phase, bool is_target_detected) {
+  return (phase == MotionPhase::kChasing ||
+          phase == MotionPhase::kExploration) &&
+         is_target_detected;
+}
+constexpr bool IsBatteryEnough(int battery_level) { return battery_level > 0; }
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_MONITOR_H_
@@ -0,0 +1,78 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_REPLAY_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_REPLAY_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "my_robotics_library/backend/thread_pool.h"
+#include "my_robotics_library/frontend/flight_recorder.h"
+#include "my_robotics_library/frontend/wrapper.h"
+
+namespace my_robotics_library {
+
+struct ReplayOptions {
+  // The asynchronous chasing planner is always replaced by the synchronous
+  // one, since its timing is not part of the log.
+  Parameter parameter;
+  // Restores what the log does not hold, e.g. the obstacle map
+  std::function<void(Wrapper &)> setup;
+  double control_tolerance{1e-9};
+};
+
+// One emitted decision: a kTransition or kControl record
+struct ReplayDecision {
+  FlightRecordType type{FlightRecordType::kEmpty};
+  double t{0.0};
+  MotionPhase phase{MotionPhase::kIdle};
+  double input{0.0}; // kControl only
+};
+
+struct ReplayResult {
+  bool is_loaded{false};
+  bool is_diverged{false};
+  size_t num_callbacks{0};
+  size_t num_compared{0};
+  // first mismatching decision, valid when is_diverged. An empty type
+  // means that side ended early.
+  size_t divergence_index{0};
+  ReplayDecision expected;
+  ReplayDecision actual;
+};
+
+// Re-drives a fresh Wrapper on a simulated clock with the ticks, commands
+// and sensor snapshots of a log, then compares the transitions and controls
+// it emits against those recorded. Deterministic and faster than real time.
+// Every clock read of a callback returns the time recorded for it, so logs
+// recorded on any clock compare exactly.
+ReplayResult ReplayFlightLog(const FlightLogReader &baseline,
+                             const ReplayOptions &options);
+
+// Replays every log on the pool; results follow the order of paths
+std::vector<ReplayResult>
+ReplayFlightLogs(const std::vector<std::string> &paths,
+                 const ReplayOptions &options,
+                 ThreadPool &thread_pool = GetDefaultThreadPool());
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_REPLAY_H_
@@ -0,0 +1,170 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_SHARED_MEMORY_TRANSPORT_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_SHARED_MEMORY_TRANSPORT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "my_robotics_library/backend/spsc_ring.h"
+#include "my_robotics_library/backend/types.h"
+
+namespace my_robotics_library {
+
+class Wrapper;
+
+enum class SensorMessageType : uint32_t {
+  kVelocity,
+  kPosition,
+  kTargetPosition,
+  kTargetLost,
+  kBatteryLevel,
+  kHoveringCommand,
+  kChasingCommand
+};
+
+// Fixed 40-byte message from a frontend process to the wrapper process.
+struct SensorMessage {
+  SensorMessageType type{SensorMessageType::kVelocity};
+  int32_t battery_level{0}; // kBatteryLevel
+  // kVelocity, kPosition and kTargetPosition as (t, x, y, z)
+  double data[4]{};
+};
+
+enum class WrapperOutputType : uint32_t { kControl, kTransition };
+
+// Fixed 32-byte message from the wrapper process to a frontend process.
+struct WrapperOutputMessage {
+  WrapperOutputType type{WrapperOutputType::kControl};
+  // kControl: MotionPhase of the control, kTransition: new MotionPhase
+  int32_t phase{0};
+  // kTransition: previous MotionPhase
+  int32_t previous{0};
+  uint32_t reserved{0};
+  double t{0.0}; // kControl: control t, kTransition: time of the transition
+  double input{0.0}; // kControl
+};
+
+// POSIX shared-memory segment holding one sensor ring into the wrapper
+// process and one output ring out of it. Messages are copied straight into
+// the mapped rings, so once both sides have mapped the segment a message
+// costs two copies and no syscall. Each ring has exactly one producer and
+// one consumer; a side waiting for messages polls.
+class SharedMemoryChannel {
+public:
+  static constexpr size_t kSensorCapacity = 1024;
+  static constexpr size_t kOutputCapacity = 1024;
+  using SensorRing = SpscRing<SensorMessage, kSensorCapacity>;
+  using OutputRing = SpscRing<WrapperOutputMessage, kOutputCapacity>;
+
+  SharedMemoryChannel() = default;
+  ~SharedMemoryChannel() { Close(); }
+
+  SharedMemoryChannel(const SharedMemoryChannel &) = delete;
+  SharedMemoryChannel &operator=(const SharedMemoryChannel &) = delete;
+
+  // Creates the segment under a name such as "/robot0". A segment left
+  // behind by a crashed process is replaced, while one whose creator is
+  // still running, or that this build cannot read, makes Create fail.
+  // Meant for the wrapper side.
+  bool Create(const std::string &name);
+  // Maps a segment created by another process; false if it does not exist
+  // or was created by an incompatible build
+  bool Open(const std::string &name);
+  // Unmaps the segment. The creating side also removes the name, while
+  // processes that opened it keep their mapping until they close.
+  void Close();
+  bool IsOpen() const { return segment_ != nullptr; }
+
+  // requires IsOpen()
+  SensorRing &GetSensorRing();
+  OutputRing &GetOutputRing();
+
+private:
+  struct Segment;
+
+  // maps a compatible segment created by another channel, or nullptr
+  static Segment *MapExisting(const std::string &name);
+  // removes the segment under name if its creator has exited
+  static bool RemoveIfStale(const std::string &name);
+
+  Segment *segment_{nullptr};
+  std::string name_;
+  bool is_creator_{false};
+};
+
+// Frontend side of a channel: posts sensor readings and commands to the
+// wrapper process and reads back its controls and transitions. Calls
+// belong to one thread, and the Send functions return false while the
+// sensor ring is full.
+class SharedMemoryClient {
+public:
+  explicit SharedMemoryClient(SharedMemoryChannel &channel)
+      : channel_(channel) {}
+
+  bool SendVelocity(const TimedVelocity &velocity);
+  bool SendPosition(const TimedPosition &position);
+  bool SendTargetPosition(const TimedPosition &target_position);
+  bool SendTargetLost();
+  bool SendBatteryLevel(int level);
+  bool SendHoveringCommand();
+  bool SendChasingCommand();
+  bool Send(const SensorMessage &message);
+
+  // false if no output is pending
+  bool Receive(WrapperOutputMessage &message);
+
+private:
+  SharedMemoryChannel &channel_;
+};
+
+// Wrapper side of a channel, run from the control thread. Sensor messages
+// go through the regular setters and commands are posted for the next
+// tick; after every tick the new transitions and the current control are
+// pushed out.
+class SharedMemoryWrapperAdaptor {
+public:
+  SharedMemoryWrapperAdaptor(Wrapper &wrapper, SharedMemoryChannel &channel);
+
+  // Hands every pending sensor message to the wrapper; returns how many
+  size_t Poll();
+  // Pushes the transitions since the last call, then the current control.
+  // A transition's previous phase is the one published before it, so
+  // transitions already overwritten in the history are folded into the
+  // first one sent. Messages that do not fit in the output ring are dropped.
+  void Publish();
+  // Poll, OnTimerCallback and Publish; the body of a control loop
+  void Step();
+
+  uint64_t GetNumDropped() const { return num_dropped_; }
+
+private:
+  Wrapper &wrapper_;
+  SharedMemoryChannel &channel_;
+  uint64_t num_published_transitions_;
+  MotionPhase last_published_phase_;
+  uint64_t num_dropped_{0};
+
+  void Push(const WrapperOutputMessage &message);
+};
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_SHARED_MEMORY_TRANSPORT_H_
@@ -0,0 +1,85 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_STATE_HISTORY_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_STATE_HISTORY_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "my_robotics_library/backend/types.h"
+
+namespace my_robotics_library {
+
+struct State {
+  MotionPhase motion_phase{MotionPhase::kIdle};
+  // phase to go back to once a hold is lifted, set on entering kHolding
+  MotionPhase resume_phase{MotionPhase::kIdle};
+};
+
+struct TimedState {
+  double t{0.0};
+  State state;
+};
+
+// Fixed-capacity ring buffer of state transitions. Once full, the oldest
+// entry is overwritten, so pushing never allocates.
+// Timestamps are expected to be non-decreasing.
+class StateHistory {
+public:
+  static constexpr size_t kCapacity = 128;
+
+  StateHistory() = default;
+
+  void Push(const State &state, double t);
+  void Clear();
+
+  size_t Size() const { return size_; }
+  bool Empty() const { return size_ == 0; }
+  // pushes since construction or the last Clear, including overwritten ones
+  uint64_t GetNumPushed() const { return num_pushed_; }
+
+  // index 0 is the oldest entry still held
+  const TimedState &At(size_t index) const;
+  const State &Back() const { return At(size_ - 1).state; }
+  const TimedState &BackTimed() const { return At(size_ - 1); }
+  // the state before Back(). Requires Size() >= 2
+  const State &Previous() const { return At(size_ - 2).state; }
+
+  // number of transitions with timestamp strictly greater than t
+  size_t CountSince(double t) const;
+
+  template <typename Visitor>
+  void ForEachSince(double t, Visitor &&visitor) const {
+    for (size_t i = FirstIndexAfter(t); i < size_; i++)
+      visitor(At(i));
+  }
+
+private:
+  std::array<TimedState, kCapacity> buffer_;
+  size_t head_{0}; // slot of the oldest entry
+  size_t size_{0};
+  uint64_t num_pushed_{0};
+
+  size_t FirstIndexAfter(double t) const;
+};
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_STATE_HISTORY_H_
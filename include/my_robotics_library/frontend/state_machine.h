@@ -0,0 +1,267 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_STATE_MACHINE_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_STATE_MACHINE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "my_robotics_library/backend/types.h"
+#include "my_robotics_library/frontend/monitor.h"
+
+namespace my_robotics_library {
+
+// What the guards look at when choosing the event of a tick
+struct StateMachineInput {
+  Monitor monitor;
+  bool is_chasing_replan_due{false};
+  bool is_target_detected{false};
+  // phase to go back to once a hold is lifted
+  MotionPhase resume_phase{MotionPhase::kIdle};
+};
+
+// planning run by the wrapper when a transition fires
+enum class TransitionAction : uint8_t {
+  kNone,
+  kPlanHovering,
+  kPlanLanding,
+  kPlanChasing
+};
+constexpr size_t kNumTransitionActions = 4;
+
+using TransitionGuard = bool (*)(const StateMachineInput &);
+
+struct Transition {
+  MonitorEvent event{MonitorEvent::kNone};
+  // nullptr: the event never fires in this phase
+  TransitionGuard guard{nullptr};
+  MotionPhase next_phase{MotionPhase::kIdle};
+  TransitionAction action{TransitionAction::kNone};
+  bool is_declared{false};
+  // set with guard, so the table checks below never compare a function
+  // pointer with null, which -fsanitize=undefined makes non-constant
+  bool is_guarded{false};
+};
+
+namespace state_machine {
+
+constexpr bool Always(const StateMachineInput &) { return true; }
+constexpr bool IsTargetDetected(const StateMachineInput &input) {
+  return input.is_target_detected;
+}
+constexpr bool IsBatteryLow(const StateMachineInput &input) {
+  return !input.monitor.is_battery_enough;
+}
+constexpr bool IsUnsafe(const StateMachineInput &input) {
+  return !input.monitor.is_safe_for_short_horizon;
+}
+constexpr bool IsTargetVisible(const StateMachineInput &input) {
+  return input.monitor.is_planning_visible;
+}
+constexpr bool IsTargetLost(const StateMachineInput &input) {
+  return !input.monitor.is_planning_visible;
+}
+constexpr bool IsChasingReplanDue(const StateMachineInput &input) {
+  return input.monitor.is_planning_visible && input.is_chasing_replan_due;
+}
+constexpr bool CanResume(const StateMachineInput &input, MotionPhase phase) {
+  return input.monitor.is_safe_for_short_horizon &&
+         input.resume_phase == phase;
+}
+constexpr bool ResumesHovering(const StateMachineInput &input) {
+  return CanResume(input, MotionPhase::kHovering);
+}
+// a chase interrupted by a hold resumes as exploration if the target is gone
+constexpr bool ResumesExploration(const StateMachineInput &input) {
+  return CanResume(input, MotionPhase::kExploration) ||
+         (CanResume(input, MotionPhase::kChasing) && !input.is_target_detected);
+}
+constexpr bool ResumesChasing(const StateMachineInput &input) {
+  return CanResume(input, MotionPhase::kChasing) && input.is_target_detected;
+}
+// a low battery lands even while holding
+constexpr bool LandsFromHolding(const StateMachineInput &input) {
+  return IsBatteryLow(input) || CanResume(input, MotionPhase::kLanding);
+}
+// ...and keeps landing when unsafe, or holding would land again right away
+constexpr bool HoldsFromLanding(const StateMachineInput &input) {
+  return IsUnsafe(input) && !IsBatteryLow(input);
+}
+
+// guard must not be nullptr; use Ignore for events that never fire
+constexpr Transition Fire(MonitorEvent event, TransitionGuard guard,
+                          MotionPhase next_phase,
+                          TransitionAction action = TransitionAction::kNone) {
+  return Transition{event, guard, next_phase, action, true, true};
+}
+constexpr Transition Ignore(MonitorEvent event) {
+  return Transition{event, nullptr, MotionPhase::kIdle,
+                    TransitionAction::kNone, true, false};
+}
+
+// commands apply in every phase
+constexpr Transition HoverCommand() {
+  return Fire(kHoverCommand, Always, MotionPhase::kHovering,
+              TransitionAction::kPlanHovering);
+}
+constexpr Transition ChaseCommand() {
+  return Fire(kChaseCommand, IsTargetDetected, MotionPhase::kChasing,
+              TransitionAction::kPlanChasing);
+}
+
+using Row = std::array<Transition, kNumMonitorEvents>;
+using Table = std::array<Row, kNumMotionPhases>;
+
+// Rows follow MotionPhase, columns follow MonitorEvent
+inline constexpr Table kTransitionTable = {{
+    // kLanding
+    {{Ignore(kHover), Ignore(kLand),
+      Fire(kHoldStop, HoldsFromLanding, MotionPhase::kHolding),
+      Ignore(kExplore),
+      Ignore(kChaseReplan), HoverCommand(), ChaseCommand(), Ignore(kNone)}},
+    // kHolding
+    {{Fire(kHover, ResumesHovering, MotionPhase::kHovering,
+           TransitionAction::kPlanHovering),
+      Fire(kLand, LandsFromHolding, MotionPhase::kLanding,
+           TransitionAction::kPlanLanding),
+      Ignore(kHoldStop),
+      Fire(kExplore, ResumesExploration, MotionPhase::kExploration),
+      Fire(kChaseReplan, ResumesChasing, MotionPhase::kChasing,
+           TransitionAction::kPlanChasing),
+      HoverCommand(), ChaseCommand(), Ignore(kNone)}},
+    // kExploration
+    {{Ignore(kHover),
+      Fire(kLand, IsBatteryLow, MotionPhase::kLanding,
+           TransitionAction::kPlanLanding),
+      Fire(kHoldStop, IsUnsafe, MotionPhase::kHolding), Ignore(kExplore),
+      Fire(kChaseReplan, IsTargetVisible, MotionPhase::kChasing,
+           TransitionAction::kPlanChasing),
+      HoverCommand(), ChaseCommand(), Ignore(kNone)}},
+    // kChasing
+    {{Ignore(kHover),
+      Fire(kLand, IsBatteryLow, MotionPhase::kLanding,
+           TransitionAction::kPlanLanding),
+      Fire(kHoldStop, IsUnsafe, MotionPhase::kHolding),
+      Fire(kExplore, IsTargetLost, MotionPhase::kExploration),
+      Fire(kChaseReplan, IsChasingReplanDue, MotionPhase::kChasing,
+           TransitionAction::kPlanChasing),
+      HoverCommand(), ChaseCommand(), Ignore(kNone)}},
+    // kHovering
+    {{Ignore(kHover),
+      Fire(kLand, IsBatteryLow, MotionPhase::kLanding,
+           TransitionAction::kPlanLanding),
+      Fire(kHoldStop, IsUnsafe, MotionPhase::kHolding), Ignore(kExplore),
+      Ignore(kChaseReplan), HoverCommand(), ChaseCommand(), Ignore(kNone)}},
+    // kIdle
+    {{Ignore(kHover),
+      Fire(kLand, IsBatteryLow, MotionPhase::kLanding,
+           TransitionAction::kPlanLanding),
+      Fire(kHoldStop, IsUnsafe, MotionPhase::kHolding), Ignore(kExplore),
+      Ignore(kChaseReplan), HoverCommand(), ChaseCommand(), Ignore(kNone)}},
+}};
+
+// Safety first, then commands; guards of the monitor events after them are
+// mutually exclusive
+inline constexpr std::array<MonitorEvent, kNumMonitorEvents - 1>
+    kEventPriority = {kLand,  kHoldStop,   kHoverCommand, kChaseCommand,
+                      kHover, kExplore, kChaseReplan};
+
+constexpr uint32_t kCommandEvents =
+    (1u << kHoverCommand) | (1u << kChaseCommand);
+
+constexpr bool IsPrioritized() {
+  uint32_t events = 0;
+  for (auto event : kEventPriority)
+    events |= 1u << event;
+  return events == (1u << kNone) - 1;
+}
+
+constexpr bool IsComplete(const Table &table) {
+  for (size_t phase = 0; phase < kNumMotionPhases; phase++)
+    for (size_t event = 0; event < kNumMonitorEvents; event++)
+      if (!table[phase][event].is_declared ||
+          table[phase][event].event != static_cast<MonitorEvent>(event))
+        return false;
+  return true;
+}
+
+// kNone never fires and nothing leads back to kIdle
+constexpr bool IsWellFormed(const Table &table) {
+  for (size_t phase = 0; phase < kNumMotionPhases; phase++) {
+    if (table[phase][kNone].is_guarded)
+      return false;
+    for (const auto &transition : table[phase])
+      if (transition.is_guarded && transition.next_phase == MotionPhase::kIdle)
+        return false;
+  }
+  return true;
+}
+
+constexpr bool IsEveryPhaseReachable(const Table &table) {
+  bool is_reached[kNumMotionPhases] = {};
+  is_reached[MotionPhase::kIdle] = true;
+  for (size_t pass = 0; pass < kNumMotionPhases; pass++)
+    for (size_t phase = 0; phase < kNumMotionPhases; phase++)
+      if (is_reached[phase])
+        for (const auto &transition : table[phase])
+          if (transition.is_guarded)
+            is_reached[transition.next_phase] = true;
+  for (bool reached : is_reached)
+    if (!reached)
+      return false;
+  return true;
+}
+
+static_assert(IsComplete(kTransitionTable),
+              "every (MotionPhase, MonitorEvent) pair must be declared");
+static_assert(IsWellFormed(kTransitionTable),
+              "kNone must not fire and kIdle must not be re-entered");
+static_assert(IsEveryPhaseReachable(kTransitionTable),
+              "every MotionPhase must be reachable from kIdle");
+static_assert(IsPrioritized(),
+              "every event but kNone must appear once in kEventPriority");
+
+} // namespace state_machine
+
+inline const Transition &GetTransition(MotionPhase phase, MonitorEvent event) {
+  return state_machine::kTransitionTable[phase][event];
+}
+
+// First event by priority whose guard holds in the phase, or kNone.
+// Command events are only considered when set in posted_events (bits by
+// MonitorEvent). Constant cost: one guard call per event at most.
+inline MonitorEvent SelectMonitorEvent(MotionPhase phase,
+                                       const StateMachineInput &input,
+                                       uint32_t posted_events = 0) {
+  const auto &row = state_machine::kTransitionTable[phase];
+  for (auto event : state_machine::kEventPriority) {
+    uint32_t bit = 1u << event;
+    if ((state_machine::kCommandEvents & bit) && !(posted_events & bit))
+      continue;
+    if (row[event].is_guarded && row[event].guard(input))
+      return event;
+  }
+  return MonitorEvent::kNone;
+}
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_STATE_MACHINE_H_
@@ -0,0 +1,123 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_TRACING_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_TRACING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "my_robotics_library/backend/types.h"
+#include "my_robotics_library/frontend/monitor.h"
+
+// Hot-path instrumentation of the Wrapper. The MRL_TRACE_* macros expand to
+// nothing unless the library is configured with
+// -DMY_ROBOTICS_LIBRARY_ENABLE_TRACING=ON.
+#ifdef MY_ROBOTICS_LIBRARY_ENABLE_TRACING
+#define MRL_TRACE_CONCAT_INNER(a, b) a##b
+#define MRL_TRACE_CONCAT(a, b) MRL_TRACE_CONCAT_INNER(a, b)
+#define MRL_TRACE_SCOPE(stage)                                                 \
+  ::my_robotics_library::TraceScope MRL_TRACE_CONCAT(trace_scope_, __LINE__)( \
+      stage)
+#define MRL_TRACE_EVENT(event)                                                 \
+  ::my_robotics_library::Tracer::CountEvent(event)
+#define MRL_TRACE_TRANSITION(from, to)                                         \
+  ::my_robotics_library::Tracer::CountTransition(from, to)
+#else
+#define MRL_TRACE_SCOPE(stage) static_cast<void>(0)
+#define MRL_TRACE_EVENT(event) static_cast<void>(0)
+#define MRL_TRACE_TRANSITION(from, to) static_cast<void>(0)
+#endif
+
+namespace my_robotics_library {
+
+enum class TraceStage : uint8_t {
+  kTimerTick,
+  kHoveringCommand,
+  kChasingCommand,
+  kGetControl,
+  kReadSensorSnapshot,
+  kUpdateMonitor,
+  kReadMonitorEvent,
+  kHandleHovering,
+  kHandleLanding,
+  kHandleChasingPlan,
+  kPlanning,
+  kNumStages
+};
+
+struct TraceStageStatistics {
+  uint64_t count{0};
+  uint64_t total_ns{0};
+  uint64_t max_ns{0};
+};
+
+// Every traced thread appends to its own buffer: a ring of the last
+// kRecordCapacity stage timings plus counters, written without locks or
+// atomic read-modify-writes. A buffer is allocated on the first record of a
+// thread. When the thread exits, the buffer passes with its contents to the
+// next thread that records, so memory follows the peak number of traced
+// threads rather than thread churn, and a dump still covers exited threads.
+// Aggregation, Reset and the dumps are meant for when traced threads are
+// idle, e.g. after landing or in a test.
+class Tracer {
+public:
+  static constexpr size_t kRecordCapacity = 1 << 16;
+
+  static uint64_t NowNanoseconds();
+
+  static void RecordStage(TraceStage stage, uint64_t begin_ns,
+                          uint64_t end_ns);
+  static void CountEvent(MonitorEvent event);
+  static void CountTransition(MotionPhase from, MotionPhase to);
+
+  // aggregated over all threads
+  static TraceStageStatistics GetStageStatistics(TraceStage stage);
+  static uint64_t GetEventCount(MonitorEvent event);
+  static uint64_t GetTransitionCount(MotionPhase from, MotionPhase to);
+  static void Reset();
+
+  // chrome://tracing / Perfetto JSON, counters included as counter events
+  static bool WriteChromeTrace(const std::string &path);
+  // Compact little-endian dump, see tracing.cc for the layout
+  static bool WriteBinaryTrace(const std::string &path);
+
+  static const char *GetStageName(TraceStage stage);
+};
+
+class TraceScope {
+public:
+  explicit TraceScope(TraceStage stage)
+      : stage_(stage), begin_ns_(Tracer::NowNanoseconds()) {}
+  ~TraceScope() {
+    Tracer::RecordStage(stage_, begin_ns_, Tracer::NowNanoseconds());
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  TraceStage stage_;
+  uint64_t begin_ns_;
+};
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_TRACING_H_
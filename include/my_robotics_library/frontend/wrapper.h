@@ -21,22 +21,29 @@
 
 #include "cmath"
 
+#include "my_robotics_library/backend/clock.h"
 #include "my_robotics_library/backend/obstacle_manager.h"
+#include "my_robotics_library/backend/planners/async_chasing_planner.h"
 #include "my_robotics_library/backend/planners/chasing_planner.h"
 #include "my_robotics_library/backend/planners/height_planner.h"
+#include "my_robotics_library/backend/planners/motion_planning_result_store.h"
+#include "my_robotics_library/backend/point_cloud_ingestor.h"
+#include "my_robotics_library/backend/seqlock.h"
+#include "my_robotics_library/backend/target_predictor.h"
 
 #include <memory>
 #include <optional>
+#include <shared_mutex>
 
 #include "my_robotics_library/backend/types.h"
+#include "my_robotics_library/frontend/control_streamer.h"
+#include "my_robotics_library/frontend/event_queue.h"
+#include "my_robotics_library/frontend/flight_recorder.h"
+#include "my_robotics_library/frontend/monitor.h"
+#include "my_robotics_library/frontend/state_history.h"
+#include "my_robotics_library/frontend/state_machine.h"
 
 namespace my_robotics_library {
-struct Monitor {
-  bool is_planning_visible{false};
-  bool is_safe_for_short_horizon{true};
-  bool is_battery_enough{true};
-};
-
 struct SensorInformation {
   TimedVelocity velocity;
   TimedPosition position;
@@ -44,47 +51,131 @@ struct SensorInformation {
   int battery_level{1};
 };
 
-enum MonitorEvent { kHover, kLand, kHoldStop, kExplore, kChaseReplan, kNone };
-
-struct State {
-  MotionPhase motion_phase{MotionPhase::kIdle};
-};
-
+// Setters may be called from sensor threads; they publish into a seqlock
+// that the control thread snapshots at the start of every timer tick or
+// command. Callbacks and GetControl belong to a single control thread.
+// After warm-up, the setters, callbacks, posted commands and GetControl
+// never allocate, whatever the planner configuration and with a flight
+// recorder or control streamer attached (see test/allocation_test.cc).
+// Only tracing builds need the warm-up, to set up the trace buffer of each
+// thread. Editing obstacles and IngestPointCloud may allocate.
 class Wrapper {
 public:
-  Wrapper();
+  explicit Wrapper(std::shared_ptr<const Clock> clock = GetDefaultClock());
+  explicit Wrapper(const Parameter &parameter,
+                   std::shared_ptr<const Clock> clock = GetDefaultClock());
 
   void SetVelocity(const TimedVelocity &velocity);
   void SetPosition(const TimedPosition &position);
+  // target_position->t is a time of the Wrapper's clock; see
+  // Parameter::use_target_prediction
   void SetTargetPosition(const std::optional<TimedPosition> &target_position);
   void SetBatteryLevel(int level);
+  // Adds a depth frame observed at time t to the obstacle map. Points are
+  // downsampled in parallel without holding the map; only the merge, in
+  // slices of parameter.point_cloud.merge_slice voxels, waits for the
+  // control thread to finish a tick. Obstacles not observed again within
+  // parameter.point_cloud.window expire.
+  // Call from one sensor thread, and do not edit obstacles through
+  // GetObstacleManager meanwhile. Merges also wait for asynchronous
+  // sampling plans, which read the map off the control thread.
+  void IngestPointCloud(const PointCloudView &cloud, double t);
 
   Control GetControl() const;
 
+  // Handle the pending commands and monitor events to a fixed point, at
+  // most parameter.max_events_per_tick transitions per call.
   void OnTimerCallback();
   void OnHoveringCommandCallback();
   void OnChasingCommandCallback();
+  // Queue a command for the next tick; safe from any thread. A command
+  // rejected on that tick, e.g. a chase without a target, is dropped.
+  void PostHoveringCommand();
+  void PostChasingCommand();
+
+  const StateHistory &GetStateHistory() const { return state_history_; }
+  const backend::MotionPlanningResultStore &GetMotionPlanningResult() const {
+    return motion_planning_result_;
+  }
+  // Obstacles should be edited from the control thread, outside callbacks.
+  // With parameter.use_async_chasing_planner and
+  // use_sampling_chasing_planner both set, plans read the map on a worker
+  // thread, so hold LockObstacles() while editing.
+  backend::ObstacleManager &GetObstacleManager() { return obstacle_manager_; }
+  std::unique_lock<std::shared_mutex> LockObstacles() {
+    return std::unique_lock<std::shared_mutex>(obstacle_mutex_);
+  }
+
+  // Logs ticks, commands, the sensor snapshots they read, events,
+  // transitions and controls. The recorder must outlive the wrapper;
+  // nullptr stops recording.
+  void SetFlightRecorder(FlightRecorder *flight_recorder) {
+    flight_recorder_ = flight_recorder;
+  }
+
+  // Publishes the phase and plan to the streamer now and after every tick
+  // or command, so it samples the active plan between ticks. The streamer
+  // must outlive the wrapper; nullptr stops publishing.
+  void SetControlStreamer(ControlStreamer *control_streamer);
+
+  // While degraded, the safety monitor only checks the current position and
+  // skips sampling the look-ahead of the plan. Meant for ticks at risk of
+  // missing their deadline; set from the control thread.
+  void SetDegraded(bool is_degraded) { is_degraded_ = is_degraded; }
+  bool IsDegraded() const { return is_degraded_; }
 
 private:
+  std::shared_ptr<const Clock> clock_;
+  // clock_, latched for the duration of every callback so the decisions of
+  // a tick share the time recorded for it
+  std::shared_ptr<LatchedClock> callback_clock_;
   Parameter parameter_;
-  SensorInformation sensor_information_;
+  SeqLock<SensorInformation> sensor_buffer_;
+  SensorInformation sensor_information_; // snapshot owned by control thread
   Monitor monitor_;
-  std::vector<State> state_history_;
-  std::shared_ptr<MotionPlanningResult> motion_planning_result_;
+  StateHistory state_history_;
+  backend::MotionPlanningResultStore motion_planning_result_;
 
+  backend::ObstacleManager obstacle_manager_;
+  TrajectorySamples lookahead_trajectory_;
   backend::HeightPlanner height_planner_;
   backend::ChasingPlanner chasing_planner_;
-
+  backend::TargetPredictor target_predictor_;
+  // held shared by ticks, commands and asynchronous sampling plans,
+  // exclusively by point cloud merges and LockObstacles
+  std::shared_mutex obstacle_mutex_;
+  backend::PointCloudIngestor point_cloud_ingestor_;
+  // only created when parameter_.use_async_chasing_planner is set
+  std::unique_ptr<backend::AsyncChasingPlanner> async_chasing_planner_;
+  double chasing_request_time_{0.0};
+  FlightRecorder *flight_recorder_{nullptr};
+  ControlStreamer *control_streamer_{nullptr};
+  EventQueue event_queue_;
+  bool is_degraded_{false};
+
+  // the latched time inside callbacks
+  double GetCurrentTime() const;
+  void PushState(const State &state);
+  void ReadSensorSnapshot();
+
+  bool IsLookaheadSafe();
   void UpdateMonitor();
-  MonitorEvent ReadMonitorEvent() const;
-
-  State ProcessEvent(const State &state, const MonitorEvent &event);
-
-  State HandleLanding(const State &state);
-  State HandleHoldStop(const State &state);
-  State HandleExploration(const State &state);
-  State HandleChasingPlan(const State &state);
-  State HandleHovering(const State &state);
+  MonitorEvent ReadMonitorEvent(uint32_t posted_events) const;
+  void ProcessEvents();
+  Control GenerateControl(double current_time) const;
+
+  // Applies the transition declared for the event in kTransitionTable.
+  // Returns the state unchanged if its planning action fails.
+  State ProcessEvent(const State &state, MonitorEvent event);
+
+  // planning actions of the transitions, indexed by TransitionAction
+  bool HandleNothing() { return true; }
+  bool HandleHovering();
+  bool HandleLanding();
+  bool HandleChasingPlan(); // false without a target
+  static constexpr bool (Wrapper::*kActionHandlers[kNumTransitionActions])() =
+      {&Wrapper::HandleNothing, &Wrapper::HandleHovering,
+       &Wrapper::HandleLanding, &Wrapper::HandleChasingPlan};
 };
 } // namespace my_robotics_library
 
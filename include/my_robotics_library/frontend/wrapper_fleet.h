@@ -0,0 +1,142 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#ifndef SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_WRAPPER_FLEET_H_
+#define SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_WRAPPER_FLEET_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "my_robotics_library/backend/clock.h"
+#include "my_robotics_library/backend/obstacle_manager.h"
+#include "my_robotics_library/backend/planners/chasing_planner.h"
+#include "my_robotics_library/backend/planners/height_planner.h"
+#include "my_robotics_library/backend/planners/motion_planning_result_store.h"
+#include "my_robotics_library/backend/target_predictor.h"
+#include "my_robotics_library/backend/thread_pool.h"
+#include "my_robotics_library/backend/types.h"
+#include "my_robotics_library/frontend/state_machine.h"
+
+namespace my_robotics_library {
+
+// Runs the Wrapper pipeline for many vehicles at once. Sensor, monitor and
+// phase state live in structure-of-arrays form; each tick evaluates the
+// monitor for a block of vehicles in flat passes, then settles the events
+// of each vehicle with the same state machine as Wrapper. Blocks are
+// sharded across the thread pool.
+// Given the same inputs and a SimulatedClock, every vehicle makes the same
+// decisions as a Wrapper posted the same commands and ticked with
+// OnTimerCallback. All vehicles share one obstacle map. The asynchronous
+// and sampling chasing planners are not supported.
+// Setters, commands and Tick belong to a single control thread.
+class WrapperFleet {
+public:
+  explicit WrapperFleet(size_t num_vehicles,
+                        const Parameter &parameter = Parameter(),
+                        std::shared_ptr<const Clock> clock = GetDefaultClock(),
+                        ThreadPool &thread_pool = GetDefaultThreadPool());
+
+  WrapperFleet(const WrapperFleet &) = delete;
+  WrapperFleet &operator=(const WrapperFleet &) = delete;
+
+  size_t Size() const { return num_vehicles_; }
+
+  void SetVelocity(size_t vehicle, const TimedVelocity &velocity);
+  void SetPosition(size_t vehicle, const TimedPosition &position);
+  void SetTargetPosition(size_t vehicle,
+                         const std::optional<TimedPosition> &target_position);
+  void SetBatteryLevel(size_t vehicle, int level);
+  // handled on the next Tick, which drops a command it rejects
+  void PostHoveringCommand(size_t vehicle);
+  void PostChasingCommand(size_t vehicle);
+
+  // OnTimerCallback for every vehicle
+  void Tick();
+
+  MotionPhase GetMotionPhase(size_t vehicle) const {
+    return static_cast<MotionPhase>(motion_phase_[vehicle]);
+  }
+  // number of states pushed, as in Wrapper's StateHistory
+  uint64_t GetNumTransitions(size_t vehicle) const {
+    return num_transitions_[vehicle];
+  }
+  Control GetControl(size_t vehicle) const;
+
+  // obstacles should be edited between ticks
+  backend::ObstacleManager &GetObstacleManager() { return obstacle_manager_; }
+
+private:
+  // vehicles per shard; one shard's arrays stay in cache during a tick
+  static constexpr size_t kBlockSize = 64;
+
+  struct BlockScratch {
+    TrajectorySamples lookahead_trajectory;
+    backend::ChasingPlanner chasing_planner;
+    explicit BlockScratch(std::shared_ptr<const Clock> clock)
+        : chasing_planner(std::move(clock)) {}
+  };
+
+  size_t num_vehicles_;
+  Parameter parameter_;
+  std::shared_ptr<const Clock> clock_;
+  ThreadPool &thread_pool_;
+  backend::ObstacleManager obstacle_manager_;
+
+  // sensors
+  std::vector<double> position_t_, position_x_, position_y_, position_z_;
+  std::vector<double> velocity_t_, velocity_x_, velocity_y_, velocity_z_;
+  std::vector<double> target_t_, target_x_, target_y_, target_z_;
+  std::vector<uint8_t> is_target_detected_;
+  std::vector<int> battery_level_;
+
+  // monitor
+  std::vector<double> obstacle_distance_;
+  std::vector<uint8_t> is_planning_visible_;
+  std::vector<uint8_t> is_safe_for_short_horizon_;
+  std::vector<uint8_t> is_battery_enough_;
+
+  // state
+  std::vector<uint8_t> motion_phase_;
+  std::vector<uint8_t> resume_phase_;
+  std::vector<uint32_t> posted_events_;
+  std::vector<double> chasing_request_time_;
+  std::vector<uint64_t> num_transitions_;
+
+  std::vector<std::unique_ptr<backend::HeightPlanner>> height_planners_;
+  std::vector<backend::TargetPredictor> target_predictors_;
+  std::vector<backend::MotionPlanningResultStore> motion_planning_results_;
+  std::vector<BlockScratch> block_scratch_;
+
+  void TickBlock(size_t block, double current_time);
+  bool IsLookaheadSafe(size_t vehicle, double current_time,
+                       TrajectorySamples &lookahead_trajectory) const;
+  void UpdateMonitor(size_t vehicle, double current_time,
+                     TrajectorySamples &lookahead_trajectory);
+  void ProcessEvents(size_t vehicle, double current_time,
+                     BlockScratch &scratch);
+  bool RunAction(TransitionAction action, size_t vehicle, double current_time,
+                 backend::ChasingPlanner &chasing_planner);
+  void PlanHeight(size_t vehicle, double target_height);
+};
+
+} // namespace my_robotics_library
+
+#endif // SIMPLE_ROBOTICS_FRONTEND_INCLUDE_FRONTEND_WRAPPER_FLEET_H_
@@ -0,0 +1,129 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/backend/planners/async_chasing_planner.h"
+#include "chrono"
+#include "cmath"
+
+using namespace my_robotics_library;
+using namespace my_robotics_library::backend;
+
+AsyncChasingPlanner::AsyncChasingPlanner(ChasingPlanner &planner,
+                                         double target_tolerance,
+                                         std::shared_mutex *planning_mutex)
+    : planner_(planner), target_tolerance_(target_tolerance),
+      planning_mutex_(planning_mutex),
+      worker_(&AsyncChasingPlanner::Run, this) {}
+
+AsyncChasingPlanner::~AsyncChasingPlanner() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  condition_.notify_one();
+  worker_.join();
+}
+
+bool AsyncChasingPlanner::Submit(const ChasingPlannerInput &planner_input) {
+  if (is_pending_) {
+    const auto &in_flight = pending_input_.target_position;
+    const auto &requested = planner_input.target_position;
+    double moved =
+        std::sqrt(std::pow(in_flight.x - requested.x, 2) +
+                  std::pow(in_flight.y - requested.y, 2) +
+                  std::pow(in_flight.z - requested.z, 2));
+    if (moved < target_tolerance_)
+      return false;
+  }
+
+  is_pending_ = true;
+  pending_input_ = planner_input;
+  uint64_t generation =
+      latest_generation_.fetch_add(1, std::memory_order_acq_rel) + 1;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    has_job_ = true;
+    job_input_ = planner_input;
+    job_generation_ = generation;
+  }
+  condition_.notify_one();
+  return true;
+}
+
+bool AsyncChasingPlanner::Poll(MotionPlanningResultStore &result_store) {
+  if (!is_ready_.load(std::memory_order_acquire))
+    return false;
+
+  bool is_fresh = back_buffer_generation_ ==
+                  latest_generation_.load(std::memory_order_acquire);
+  if (is_fresh) {
+    std::swap(result_store, back_buffer_);
+    is_pending_ = false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_ready_.store(false, std::memory_order_release);
+  }
+  condition_.notify_one();
+  return is_fresh;
+}
+
+void AsyncChasingPlanner::Cancel() {
+  if (!is_pending_)
+    return;
+  is_pending_ = false;
+  latest_generation_.fetch_add(1, std::memory_order_acq_rel);
+  std::lock_guard<std::mutex> lock(mutex_);
+  has_job_ = false;
+}
+
+void AsyncChasingPlanner::Run() {
+  while (true) {
+    ChasingPlannerInput planner_input;
+    uint64_t generation;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      auto has_work = [this] {
+        return stop_ ||
+               (has_job_ && !is_ready_.load(std::memory_order_acquire));
+      };
+      // every change of has_work notifies, so this only wakes up for work.
+      // Unlike wait(), wait_until does not need the GLIBCXX_3.4.30 runtime
+      condition_.wait_until(
+          lock, std::chrono::steady_clock::time_point::max(), has_work);
+      if (stop_)
+        return;
+      planner_input = job_input_;
+      generation = job_generation_;
+      has_job_ = false;
+    }
+
+    {
+      std::shared_lock<std::shared_mutex> planning_lock;
+      if (planning_mutex_)
+        planning_lock = std::shared_lock<std::shared_mutex>(*planning_mutex_);
+      planner_.ComputeChasingMotion(planner_input, back_buffer_);
+    }
+
+    // superseded while planning: drop it and pick up the newer job
+    if (generation != latest_generation_.load(std::memory_order_acquire))
+      continue;
+    back_buffer_generation_ = generation;
+    is_ready_.store(true, std::memory_order_release);
+  }
+}
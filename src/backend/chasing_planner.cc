@@ -17,33 +17,239 @@
  *******************************************************************************/
 
 #include "my_robotics_library/backend/planners/chasing_planner.h"
-#include "chrono"
+#include "cmath"
+#include "my_robotics_library/backend/planners/motion_planning_result_store.h"
+
+#include <algorithm>
+#include <limits>
 
 using namespace my_robotics_library;
 using namespace my_robotics_library::backend;
-using namespace std::chrono;
 
 ChasingMotionPlanningResult::ChasingMotionPlanningResult(
-    my_robotics_library::TimedPosition target_position)
-    : MotionPlanningResult(
-          MotionPhase::kChasing,
-          duration<double>(system_clock::now().time_since_epoch()).count()),
-      planned_view_position_(target_position) {}
+    const TimedPosition &view_position, const TimedVelocity &view_velocity,
+    const TimedPosition &robot_position, const TimedVelocity &robot_velocity,
+    double horizon, double t_request)
+    : MotionPlanningResult(MotionPhase::kChasing, t_request),
+      planned_view_position_(view_position),
+      planned_view_velocity_(view_velocity), horizon_(horizon) {
+  // zero acceleration at both ends
+  const double p0[3] = {robot_position.x, robot_position.y, robot_position.z};
+  const double v0[3] = {robot_velocity.x, robot_velocity.y, robot_velocity.z};
+  const double pf[3] = {view_position.x, view_position.y, view_position.z};
+  const double vf[3] = {view_velocity.x, view_velocity.y, view_velocity.z};
+  const double T = horizon;
+  for (int axis = 0; axis < 3; axis++) {
+    double displacement = pf[axis] - p0[axis];
+    double *c = coefficients_[axis];
+    c[0] = p0[axis];
+    c[1] = v0[axis];
+    c[2] = 0.0;
+    c[3] = (20 * displacement - (8 * vf[axis] + 12 * v0[axis]) * T) /
+           (2 * std::pow(T, 3));
+    c[4] = (-30 * displacement + (14 * vf[axis] + 16 * v0[axis]) * T) /
+           (2 * std::pow(T, 4));
+    c[5] = (12 * displacement - 6 * (vf[axis] + v0[axis]) * T) /
+           (2 * std::pow(T, 5));
+  }
+}
+
+TimedPosition ChasingMotionPlanningResult::EvaluatePosition(double t) const {
+  double tau = t - GetRequestTime();
+  if (tau >= horizon_) {
+    double dt = tau - horizon_;
+    return {t, planned_view_position_.x + planned_view_velocity_.x * dt,
+            planned_view_position_.y + planned_view_velocity_.y * dt,
+            planned_view_position_.z + planned_view_velocity_.z * dt};
+  }
+  tau = std::max(tau, 0.0);
+  double position[3];
+  for (int axis = 0; axis < 3; axis++) {
+    const double *c = coefficients_[axis];
+    double value = c[kNumCoefficients - 1];
+    for (int n = kNumCoefficients - 2; n >= 0; n--)
+      value = value * tau + c[n];
+    position[axis] = value;
+  }
+  return {t, position[0], position[1], position[2]};
+}
+
+double ChasingMotionPlanningResult::GetJerkCost() const {
+  // jerk = a + b tau + c tau^2 per axis, integrated in closed form
+  const double T = horizon_;
+  double cost = 0.0;
+  for (int axis = 0; axis < 3; axis++) {
+    const double *coefficient = coefficients_[axis];
+    double a = 6 * coefficient[3], b = 24 * coefficient[4],
+           c = 60 * coefficient[5];
+    cost += a * a * T + a * b * T * T + (b * b + 2 * a * c) * T * T * T / 3 +
+            b * c * std::pow(T, 4) / 2 + c * c * std::pow(T, 5) / 5;
+  }
+  return cost;
+}
 
 Control ChasingMotionPlanningResult::GenerateControl(double t) const {
   Control control;
   control.phase = GetMotionType();
   control.t = t;
-  control.input = planned_view_position_.x;
+  control.input = EvaluatePosition(t).x;
   return control;
 }
 
-std::vector<TimedPosition>
-ChasingMotionPlanningResult::GetPlanningTrajectory(double t0, double tf) const {
-  return {};
+void ChasingMotionPlanningResult::SampleTrajectory(
+    double t0, double dt, size_t num_samples, TimedPosition *samples) const {
+  for (size_t n = 0; n < num_samples; n++)
+    samples[n] = EvaluatePosition(t0 + dt * n);
+}
+
+void ChasingMotionPlanningResult::SampleTrajectory(
+    double t0, double dt, TrajectorySamples &samples) const {
+  for (size_t n = 0; n < samples.Size(); n++) {
+    auto position = EvaluatePosition(t0 + dt * n);
+    samples.t[n] = position.t;
+    samples.x[n] = position.x;
+    samples.y[n] = position.y;
+    samples.z[n] = position.z;
+  }
+}
+
+ChasingPlanner::ChasingPlanner(std::shared_ptr<const Clock> clock)
+    : clock_(std::move(clock)) {}
+
+TimedPosition
+ChasingPlanner::PredictViewPosition(const ChasingPlannerInput &planner_input) {
+  const auto &target = planner_input.target_position;
+  const auto &velocity = planner_input.target_velocity;
+  const double T = planner_input.horizon;
+  return {target.t + T, target.x + velocity.x * T, target.y + velocity.y * T,
+          target.z + velocity.z * T};
 }
 
 ChasingMotionPlanningResult ChasingPlanner::ComputeChasingMotion(
     const my_robotics_library::backend::ChasingPlannerInput &planner_input) {
-  return ChasingMotionPlanningResult(planner_input.target_position);
+  return ChasingMotionPlanningResult(
+      SelectViewPosition(planner_input), planner_input.target_velocity,
+      planner_input.robot_position, planner_input.robot_velocity,
+      planner_input.horizon, clock_->Now());
+}
+
+const ChasingMotionPlanningResult &ChasingPlanner::ComputeChasingMotion(
+    const ChasingPlannerInput &planner_input,
+    MotionPlanningResultStore &result_store) {
+  return result_store.Emplace<ChasingMotionPlanningResult>(
+      SelectViewPosition(planner_input), planner_input.target_velocity,
+      planner_input.robot_position, planner_input.robot_velocity,
+      planner_input.horizon, clock_->Now());
+}
+
+void ChasingPlanner::EnableSampling(const ChasingSamplingParameter &parameter,
+                                    double safety_distance,
+                                    const ObstacleManager *obstacle_manager,
+                                    ThreadPool *thread_pool) {
+  sampling_parameter_ = parameter;
+  safety_distance_ = safety_distance;
+  obstacle_manager_ = obstacle_manager;
+  thread_pool_ = thread_pool;
+
+  candidates_.resize(parameter.num_azimuths * parameter.num_elevations *
+                     parameter.num_distances);
+  for (auto &candidate : candidates_)
+    candidate.trajectory.Resize(parameter.num_trajectory_samples);
+}
+
+TimedPosition
+ChasingPlanner::SelectViewPosition(const ChasingPlannerInput &planner_input) {
+  auto target_view = PredictViewPosition(planner_input);
+  if (!IsSamplingEnabled() || candidates_.empty())
+    return target_view;
+
+  const auto &parameter = sampling_parameter_;
+  auto linspace = [](double begin, double end, int num, int index) {
+    return num > 1 ? begin + (end - begin) * index / (num - 1) : begin;
+  };
+  thread_pool_->ParallelFor(0, candidates_.size(), 8, [&](size_t index) {
+    auto &candidate = candidates_[index];
+    int i_distance = index % parameter.num_distances;
+    int i_elevation = (index / parameter.num_distances) %
+                      parameter.num_elevations;
+    int i_azimuth =
+        index / (parameter.num_distances * parameter.num_elevations);
+    double distance = linspace(parameter.min_view_distance,
+                               parameter.max_view_distance,
+                               parameter.num_distances, i_distance);
+    double elevation = linspace(0.0, parameter.max_elevation,
+                                parameter.num_elevations, i_elevation);
+    double azimuth = 2 * M_PI * i_azimuth / parameter.num_azimuths;
+
+    candidate.view_position = {
+        target_view.t,
+        target_view.x + distance * std::cos(elevation) * std::cos(azimuth),
+        target_view.y + distance * std::cos(elevation) * std::sin(azimuth),
+        target_view.z + distance * std::sin(elevation)};
+    candidate.cost = ScoreCandidate(planner_input, target_view, candidate);
+  });
+
+  const Candidate *best = &candidates_.front();
+  for (const auto &candidate : candidates_)
+    if (candidate.cost < best->cost)
+      best = &candidate;
+  // nothing feasible: fall back to heading for the target itself
+  if (std::isinf(best->cost))
+    return target_view;
+  return best->view_position;
+}
+
+double ChasingPlanner::ScoreCandidate(const ChasingPlannerInput &planner_input,
+                                      const TimedPosition &target_view,
+                                      Candidate &candidate) const {
+  const auto &parameter = sampling_parameter_;
+  ChasingMotionPlanningResult trajectory(
+      candidate.view_position, planner_input.target_velocity,
+      planner_input.robot_position, planner_input.robot_velocity,
+      planner_input.horizon, 0.0);
+
+  double distance_to_target = std::sqrt(
+      std::pow(candidate.view_position.x - target_view.x, 2) +
+      std::pow(candidate.view_position.y - target_view.y, 2) +
+      std::pow(candidate.view_position.z - target_view.z, 2));
+  double cost =
+      parameter.smoothness_weight * trajectory.GetJerkCost() +
+      parameter.visibility_weight *
+          std::pow(distance_to_target - parameter.desired_view_distance, 2);
+  if (!obstacle_manager_)
+    return cost;
+
+  auto &samples = candidate.trajectory;
+  trajectory.SampleTrajectory(
+      0.0, planner_input.horizon / std::max<size_t>(samples.Size() - 1, 1),
+      samples);
+  auto clearance =
+      obstacle_manager_->CheckTrajectory(samples, safety_distance_);
+  if (clearance.is_violated)
+    return std::numeric_limits<double>::infinity();
+  cost += parameter.clearance_weight /
+          std::max(clearance.min_clearance, 1e-3);
+
+  // line of sight from the view position to the target
+  const int kNumSightSamples = 8;
+  double xs[kNumSightSamples], ys[kNumSightSamples], zs[kNumSightSamples],
+      distances[kNumSightSamples];
+  for (int n = 0; n < kNumSightSamples; n++) {
+    double ratio = (n + 0.5) / kNumSightSamples;
+    xs[n] = candidate.view_position.x +
+            ratio * (target_view.x - candidate.view_position.x);
+    ys[n] = candidate.view_position.y +
+            ratio * (target_view.y - candidate.view_position.y);
+    zs[n] = candidate.view_position.z +
+            ratio * (target_view.z - candidate.view_position.z);
+  }
+  obstacle_manager_->GetDistancesToObstacle(xs, ys, zs, kNumSightSamples,
+                                            distances);
+  for (int n = 0; n < kNumSightSamples; n++) {
+    if (distances[n] < parameter.occlusion_radius) {
+      cost += parameter.occlusion_weight;
+      break;
+    }
+  }
+  return cost;
 }
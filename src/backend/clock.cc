@@ -0,0 +1,45 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/backend/clock.h"
+#include "chrono"
+
+using namespace my_robotics_library;
+using namespace std::chrono;
+
+double SystemClock::Now() const {
+  return duration<double>(system_clock::now().time_since_epoch()).count();
+}
+
+double LatchedClock::Now() const {
+  if (is_latched_.load(std::memory_order_acquire))
+    return latched_time_.load(std::memory_order_relaxed);
+  return source_->Now();
+}
+
+double LatchedClock::Latch() {
+  double t = source_->Now();
+  latched_time_.store(t, std::memory_order_relaxed);
+  is_latched_.store(true, std::memory_order_release);
+  return t;
+}
+
+std::shared_ptr<const Clock> my_robotics_library::GetDefaultClock() {
+  static const auto clock = std::make_shared<const SystemClock>();
+  return clock;
+}
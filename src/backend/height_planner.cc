@@ -16,28 +16,39 @@
  *
  *******************************************************************************/
 #include "my_robotics_library/backend/planners/height_planner.h"
+#include "my_robotics_library/backend/planners/motion_planning_result_store.h"
 
 using namespace my_robotics_library;
 using namespace my_robotics_library::backend;
-using namespace std::chrono;
+
+HeightPlanner::HeightPlanner(std::shared_ptr<const Clock> clock)
+    : clock_(std::move(clock)) {}
 
 void HeightPlanner::SetRobotPosition(
     const my_robotics_library::TimedPosition &robot_position) {
-  robot_position_ = robot_position;
+  robot_position_.Store(robot_position);
 }
 
 HeightMotionPlanningResult HeightPlanner::ComputeHeightMotion(
     const my_robotics_library::backend::HeightPlannerInput &planner_input) {
 
   return HeightMotionPlanningResult(planner_input.target_height,
-                                    &robot_position_);
+                                    &robot_position_, clock_->Now());
+}
+
+const HeightMotionPlanningResult &HeightPlanner::ComputeHeightMotion(
+    const HeightPlannerInput &planner_input,
+    MotionPlanningResultStore &result_store) {
+  return result_store.Emplace<HeightMotionPlanningResult>(
+      planner_input.target_height, &robot_position_, clock_->Now());
 }
 
 HeightMotionPlanningResult::HeightMotionPlanningResult(
-    double planned_height, TimedPosition *position_ptr)
+    double planned_height, const SeqLock<TimedPosition> *position_ptr,
+    double t_request)
     : MotionPlanningResult(
           planned_height == 0 ? MotionPhase::kLanding : MotionPhase::kHovering,
-          duration<double>(system_clock::now().time_since_epoch()).count()),
+          t_request),
       planned_height_(planned_height), robot_position_ptr_(position_ptr) {}
 
 Control HeightMotionPlanningResult::GenerateControl(double t) const {
@@ -45,20 +56,28 @@ Control HeightMotionPlanningResult::GenerateControl(double t) const {
   control.phase = GetMotionType();
   control.t = t;
 
-  double error = planned_height_ - robot_position_ptr_->z;
+  double error = planned_height_ - robot_position_ptr_->Load().z;
   if (error < 0)
     return control;
   control.input = error;
   return control;
 }
 
-std::vector<TimedPosition>
-HeightMotionPlanningResult::GetPlanningTrajectory(double t0, double tf) const {
-  const int N = 30;
-  double dt = (tf - t0) / N;
-  std::vector<TimedPosition> trajectory;
-  for (int n = 0; n < N; n++) {
-    trajectory.push_back({t0 + (tf - t0) / N * n, 0, 0, planned_height_});
+void HeightMotionPlanningResult::SampleTrajectory(
+    double t0, double dt, size_t num_samples, TimedPosition *samples) const {
+  auto robot_position = robot_position_ptr_->Load();
+  for (size_t n = 0; n < num_samples; n++)
+    samples[n] = {t0 + dt * n, robot_position.x, robot_position.y,
+                  planned_height_};
+}
+
+void HeightMotionPlanningResult::SampleTrajectory(
+    double t0, double dt, TrajectorySamples &samples) const {
+  auto robot_position = robot_position_ptr_->Load();
+  for (size_t n = 0; n < samples.Size(); n++) {
+    samples.t[n] = t0 + dt * n;
+    samples.x[n] = robot_position.x;
+    samples.y[n] = robot_position.y;
+    samples.z[n] = planned_height_;
   }
-  return trajectory;
-}
\ No newline at end of file
+}
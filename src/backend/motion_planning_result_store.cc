@@ -0,0 +1,47 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/backend/planners/motion_planning_result_store.h"
+
+using namespace my_robotics_library;
+using namespace my_robotics_library::backend;
+
+const MotionPlanningResult *MotionPlanningResultStore::Get() const {
+  if (auto height_result = std::get_if<HeightMotionPlanningResult>(&result_))
+    return height_result;
+  if (auto chasing_result = std::get_if<ChasingMotionPlanningResult>(&result_))
+    return chasing_result;
+  return nullptr;
+}
+
+Control MotionPlanningResultStore::GenerateControl(double t) const {
+  if (auto height_result = std::get_if<HeightMotionPlanningResult>(&result_))
+    return height_result->HeightMotionPlanningResult::GenerateControl(t);
+  return std::get<ChasingMotionPlanningResult>(result_)
+      .ChasingMotionPlanningResult::GenerateControl(t);
+}
+
+void MotionPlanningResultStore::SampleTrajectory(
+    double t0, double dt, TrajectorySamples &samples) const {
+  if (auto height_result = std::get_if<HeightMotionPlanningResult>(&result_))
+    height_result->HeightMotionPlanningResult::SampleTrajectory(t0, dt,
+                                                                samples);
+  else
+    std::get<ChasingMotionPlanningResult>(result_)
+        .ChasingMotionPlanningResult::SampleTrajectory(t0, dt, samples);
+}
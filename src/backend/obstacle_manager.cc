@@ -0,0 +1,388 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/backend/obstacle_manager.h"
+#include "cmath"
+
+#include <algorithm>
+
+using namespace my_robotics_library;
+using namespace my_robotics_library::backend;
+
+ObstacleManager::ObstacleManager(double voxel_size, double max_query_distance)
+    : voxel_size_(voxel_size), max_query_distance_(max_query_distance) {}
+
+size_t ObstacleManager::VoxelKeyHash::operator()(VoxelKey key) const {
+  // splitmix64 finalizer
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9ULL;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111ebULL;
+  key ^= key >> 31;
+  return static_cast<size_t>(key);
+}
+
+int ObstacleManager::ToVoxelIndex(double coordinate) const {
+  return static_cast<int>(std::floor(coordinate / voxel_size_));
+}
+
+ObstacleManager::VoxelKey ObstacleManager::ToVoxelKey(int ix, int iy,
+                                                      int iz) const {
+  // 21 bits per axis
+  const uint64_t mask = (1ULL << 21) - 1;
+  return (static_cast<uint64_t>(ix) & mask) |
+         ((static_cast<uint64_t>(iy) & mask) << 21) |
+         ((static_cast<uint64_t>(iz) & mask) << 42);
+}
+
+ObstacleManager::VoxelKey
+ObstacleManager::ToVoxelKey(const TimedPosition &position) const {
+  return ToVoxelKey(ToVoxelIndex(position.x), ToVoxelIndex(position.y),
+                    ToVoxelIndex(position.z));
+}
+
+void ObstacleManager::AddToVoxel(VoxelKey key, ObstacleId id) {
+  voxels_[key].push_back(id);
+}
+
+void ObstacleManager::RemoveFromVoxel(VoxelKey key, ObstacleId id) {
+  auto voxel = voxels_.find(key);
+  if (voxel == voxels_.end())
+    return;
+  auto &ids = voxel->second;
+  auto it = std::find(ids.begin(), ids.end(), id);
+  if (it != ids.end()) {
+    *it = ids.back();
+    ids.pop_back();
+  }
+  if (ids.empty())
+    voxels_.erase(voxel);
+}
+
+ObstacleId ObstacleManager::InsertObstacle(const TimedPosition &position) {
+  ObstacleId id;
+  if (free_ids_.empty()) {
+    id = static_cast<ObstacleId>(obstacles_.size());
+    obstacles_.emplace_back();
+  } else {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+  }
+  auto &obstacle = obstacles_[id];
+  obstacle.position = position;
+  obstacle.key = ToVoxelKey(position);
+  obstacle.is_alive = true;
+  AddToVoxel(obstacle.key, id);
+  num_obstacles_++;
+  if (IsDistanceFieldEnabled())
+    AddToField(position);
+  return id;
+}
+
+void ObstacleManager::InsertObstacles(
+    const std::vector<TimedPosition> &positions,
+    std::vector<ObstacleId> *ids) {
+  obstacles_.reserve(obstacles_.size() + positions.size());
+  voxels_.reserve(voxels_.size() + positions.size());
+  if (ids)
+    ids->reserve(ids->size() + positions.size());
+  for (const auto &position : positions) {
+    auto id = InsertObstacle(position);
+    if (ids)
+      ids->push_back(id);
+  }
+}
+
+bool ObstacleManager::UpdateObstacle(ObstacleId id,
+                                     const TimedPosition &position) {
+  if (id >= obstacles_.size() || !obstacles_[id].is_alive)
+    return false;
+  auto &obstacle = obstacles_[id];
+  auto old_position = obstacle.position;
+  auto new_key = ToVoxelKey(position);
+  if (new_key != obstacle.key) {
+    RemoveFromVoxel(obstacle.key, id);
+    AddToVoxel(new_key, id);
+    obstacle.key = new_key;
+  }
+  obstacle.position = position;
+  if (IsDistanceFieldEnabled()) {
+    RemoveFromField(old_position);
+    AddToField(position);
+  }
+  return true;
+}
+
+bool ObstacleManager::RemoveObstacle(ObstacleId id) {
+  if (id >= obstacles_.size() || !obstacles_[id].is_alive)
+    return false;
+  auto &obstacle = obstacles_[id];
+  RemoveFromVoxel(obstacle.key, id);
+  obstacle.is_alive = false;
+  free_ids_.push_back(id);
+  num_obstacles_--;
+  if (IsDistanceFieldEnabled())
+    RemoveFromField(obstacle.position);
+  return true;
+}
+
+void ObstacleManager::Clear() {
+  obstacles_.clear();
+  free_ids_.clear();
+  voxels_.clear();
+  num_obstacles_ = 0;
+  std::fill(distance_field_.begin(), distance_field_.end(),
+            static_cast<float>(field_truncation_));
+}
+
+double
+ObstacleManager::GetDistanceToObstacle(const TimedPosition &position) const {
+  double distance;
+  if (QueryField(position.x, position.y, position.z, distance))
+    return distance;
+  return QueryIndex(position.x, position.y, position.z, max_query_distance_);
+}
+
+void ObstacleManager::GetDistancesToObstacle(const double *xs,
+                                             const double *ys,
+                                             const double *zs,
+                                             size_t num_positions,
+                                             double *distances) const {
+  for (size_t n = 0; n < num_positions; n++) {
+    if (!QueryField(xs[n], ys[n], zs[n], distances[n]))
+      distances[n] = QueryIndex(xs[n], ys[n], zs[n], max_query_distance_);
+  }
+}
+
+TrajectoryClearance
+ObstacleManager::CheckTrajectory(const TrajectorySamples &trajectory,
+                                 double safety_distance) const {
+  TrajectoryClearance clearance;
+  clearance.min_clearance = max_query_distance_;
+
+  // distances are computed in fixed chunks so no buffer is allocated
+  const size_t kChunkSize = 64;
+  double distances[kChunkSize];
+  for (size_t offset = 0; offset < trajectory.Size(); offset += kChunkSize) {
+    size_t chunk_size = std::min(kChunkSize, trajectory.Size() - offset);
+    GetDistancesToObstacle(&trajectory.x[offset], &trajectory.y[offset],
+                           &trajectory.z[offset], chunk_size, distances);
+
+    for (size_t n = 0; n < chunk_size; n++) {
+      if (distances[n] < clearance.min_clearance) {
+        clearance.min_clearance = distances[n];
+        clearance.min_clearance_time = trajectory.t[offset + n];
+      }
+      if (!clearance.is_violated && distances[n] < safety_distance) {
+        clearance.is_violated = true;
+        clearance.first_violation_time = trajectory.t[offset + n];
+      }
+    }
+  }
+  return clearance;
+}
+
+void ObstacleManager::CheckTrajectories(
+    const std::vector<TrajectorySamples> &candidates, double safety_distance,
+    std::vector<TrajectoryClearance> &clearances) const {
+  clearances.resize(candidates.size());
+  for (size_t n = 0; n < candidates.size(); n++)
+    clearances[n] = CheckTrajectory(candidates[n], safety_distance);
+}
+
+double ObstacleManager::QueryIndex(double x, double y, double z,
+                                   double max_distance) const {
+  if (num_obstacles_ == 0)
+    return max_distance;
+  const TimedPosition position{0.0, x, y, z};
+
+  const int cx = ToVoxelIndex(position.x);
+  const int cy = ToVoxelIndex(position.y);
+  const int cz = ToVoxelIndex(position.z);
+  const int max_ring =
+      static_cast<int>(std::ceil(max_distance / voxel_size_));
+  double min_squared = max_distance * max_distance;
+
+  auto gap_to_voxel = [&](int index, double coordinate) {
+    return std::max({0.0, index * voxel_size_ - coordinate,
+                     coordinate - (index + 1) * voxel_size_});
+  };
+  auto visit_obstacles = [&](const std::vector<ObstacleId> &ids) {
+    for (auto id : ids) {
+      const auto &obstacle = obstacles_[id].position;
+      double dx = obstacle.x - position.x;
+      double dy = obstacle.y - position.y;
+      double dz = obstacle.z - position.z;
+      min_squared = std::min(min_squared, dx * dx + dy * dy + dz * dz);
+    }
+  };
+  size_t num_lookups = 0;
+  auto visit_voxel = [&](int ix, int iy, int iz) {
+    // skip the lookup if the whole voxel is farther than the best so far
+    double gap_x = gap_to_voxel(ix, position.x);
+    double gap_y = gap_to_voxel(iy, position.y);
+    double gap_z = gap_to_voxel(iz, position.z);
+    if (gap_x * gap_x + gap_y * gap_y + gap_z * gap_z >= min_squared)
+      return;
+    num_lookups++;
+    auto voxel = voxels_.find(ToVoxelKey(ix, iy, iz));
+    if (voxel != voxels_.end())
+      visit_obstacles(voxel->second);
+  };
+
+  for (int ring = 0; ring <= max_ring; ring++) {
+    // visit only the surface of the cube of voxels at Chebyshev radius ring
+    for (int dx = -ring; dx <= ring; dx++) {
+      for (int dy = -ring; dy <= ring; dy++) {
+        bool on_side = std::abs(dx) == ring || std::abs(dy) == ring;
+        int dz_step = on_side ? 1 : std::max(2 * ring, 1);
+        for (int dz = -ring; dz <= ring; dz += dz_step)
+          visit_voxel(cx + dx, cy + dy, cz + dz);
+      }
+    }
+    // anything outside the visited cube is at least this far away
+    double reach = std::min({position.x - (cx - ring) * voxel_size_,
+                             (cx + ring + 1) * voxel_size_ - position.x,
+                             position.y - (cy - ring) * voxel_size_,
+                             (cy + ring + 1) * voxel_size_ - position.y,
+                             position.z - (cz - ring) * voxel_size_,
+                             (cz + ring + 1) * voxel_size_ - position.z});
+    if (min_squared <= reach * reach)
+      break;
+    // in sparse maps the empty shells cost more than visiting every
+    // occupied voxel once
+    const size_t side = 2 * ring + 3;
+    const size_t next_shell = side * side * side - (side - 2) * (side - 2) *
+                                                       (side - 2);
+    if (num_lookups + next_shell > voxels_.size()) {
+      for (const auto &voxel : voxels_)
+        visit_obstacles(voxel.second);
+      break;
+    }
+  }
+  return std::sqrt(min_squared);
+}
+
+void ObstacleManager::EnableDistanceField(const DistanceFieldConfig &config) {
+  field_config_ = config;
+  field_truncation_ = std::min(config.truncation_distance, max_query_distance_);
+  distance_field_.assign(static_cast<size_t>(config.size_x) * config.size_y *
+                             config.size_z,
+                         static_cast<float>(field_truncation_));
+  for (const auto &obstacle : obstacles_)
+    if (obstacle.is_alive)
+      AddToField(obstacle.position);
+}
+
+void ObstacleManager::DisableDistanceField() {
+  distance_field_.clear();
+  distance_field_.shrink_to_fit();
+}
+
+size_t ObstacleManager::ToFieldIndex(int ix, int iy, int iz) const {
+  return (static_cast<size_t>(iz) * field_config_.size_y + iy) *
+             field_config_.size_x +
+         ix;
+}
+
+bool ObstacleManager::QueryField(double x, double y, double z,
+                                 double &distance) const {
+  if (distance_field_.empty())
+    return false;
+  const auto &config = field_config_;
+  double fx = (x - config.origin_x) / config.resolution;
+  double fy = (y - config.origin_y) / config.resolution;
+  double fz = (z - config.origin_z) / config.resolution;
+  int ix = static_cast<int>(std::floor(fx));
+  int iy = static_cast<int>(std::floor(fy));
+  int iz = static_cast<int>(std::floor(fz));
+  if (ix < 0 || iy < 0 || iz < 0 || ix + 1 >= config.size_x ||
+      iy + 1 >= config.size_y || iz + 1 >= config.size_z)
+    return false;
+
+  double wx = fx - ix, wy = fy - iy, wz = fz - iz;
+  const size_t stride_y = config.size_x;
+  const size_t stride_z = stride_y * config.size_y;
+  const float *c = &distance_field_[ToFieldIndex(ix, iy, iz)];
+  double c00 = c[0] + wx * (c[1] - c[0]);
+  double c10 = c[stride_y] + wx * (c[stride_y + 1] - c[stride_y]);
+  double c01 = c[stride_z] + wx * (c[stride_z + 1] - c[stride_z]);
+  double c11 = c[stride_z + stride_y] +
+               wx * (c[stride_z + stride_y + 1] - c[stride_z + stride_y]);
+  double c0 = c00 + wy * (c10 - c00);
+  double c1 = c01 + wy * (c11 - c01);
+  distance = c0 + wz * (c1 - c0);
+  return true;
+}
+
+template <typename Visitor>
+void ObstacleManager::ForEachFieldSampleNear(const TimedPosition &position,
+                                             Visitor &&visitor) {
+  const auto &config = field_config_;
+  auto to_range = [&](double coordinate, double origin, int size, int &begin,
+                      int &end) {
+    begin = std::max(0, static_cast<int>(std::ceil(
+                            (coordinate - field_truncation_ - origin) /
+                            config.resolution)));
+    end = std::min(size - 1, static_cast<int>(std::floor(
+                                 (coordinate + field_truncation_ - origin) /
+                                 config.resolution)));
+  };
+  int x_begin, x_end, y_begin, y_end, z_begin, z_end;
+  to_range(position.x, config.origin_x, config.size_x, x_begin, x_end);
+  to_range(position.y, config.origin_y, config.size_y, y_begin, y_end);
+  to_range(position.z, config.origin_z, config.size_z, z_begin, z_end);
+
+  const double max_squared = field_truncation_ * field_truncation_;
+  for (int iz = z_begin; iz <= z_end; iz++) {
+    double z = config.origin_z + iz * config.resolution;
+    double dz = z - position.z;
+    for (int iy = y_begin; iy <= y_end; iy++) {
+      double y = config.origin_y + iy * config.resolution;
+      double dy = y - position.y;
+      double squared_yz = dy * dy + dz * dz;
+      if (squared_yz >= max_squared)
+        continue;
+      size_t index = ToFieldIndex(x_begin, iy, iz);
+      for (int ix = x_begin; ix <= x_end; ix++, index++) {
+        double x = config.origin_x + ix * config.resolution;
+        double dx = x - position.x;
+        double squared = dx * dx + squared_yz;
+        if (squared < max_squared)
+          visitor(x, y, z, squared, distance_field_[index]);
+      }
+    }
+  }
+}
+
+void ObstacleManager::AddToField(const TimedPosition &position) {
+  ForEachFieldSampleNear(position, [](double, double, double, double squared,
+                                      float &sample) {
+    if (squared < static_cast<double>(sample) * sample)
+      sample = static_cast<float>(std::sqrt(squared));
+  });
+}
+
+void ObstacleManager::RemoveFromField(const TimedPosition &position) {
+  // only samples whose closest obstacle was the removed one can change
+  ForEachFieldSampleNear(position, [this](double x, double y, double z,
+                                          double squared, float &sample) {
+    if (sample >= static_cast<float>(std::sqrt(squared)))
+      sample = static_cast<float>(QueryIndex(x, y, z, field_truncation_));
+  });
+}
@@ -0,0 +1,164 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/backend/point_cloud_ingestor.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace my_robotics_library;
+using namespace my_robotics_library::backend;
+
+namespace {
+
+constexpr size_t kPointsPerChunk = 1 << 14;
+// 21 bits per axis, two's complement
+constexpr int kAxisBits = 21;
+constexpr uint64_t kAxisMask = (1ULL << kAxisBits) - 1;
+// sorts after every valid key
+constexpr uint64_t kInvalidKey = ~0ULL;
+
+double ToVoxelCenter(uint64_t bits, double voxel_size) {
+  auto index = static_cast<int64_t>(bits & kAxisMask);
+  if (index >= (1LL << (kAxisBits - 1)))
+    index -= 1LL << kAxisBits;
+  return (index + 0.5) * voxel_size;
+}
+
+} // namespace
+
+PointCloudIngestor::PointCloudIngestor(ObstacleManager &obstacle_manager,
+                                       const PointCloudParameter &parameter,
+                                       ThreadPool &thread_pool)
+    : obstacle_manager_(obstacle_manager), parameter_(parameter),
+      thread_pool_(thread_pool) {}
+
+uint64_t PointCloudIngestor::ToKey(const float *point) const {
+  if (!std::isfinite(point[0]) || !std::isfinite(point[1]) ||
+      !std::isfinite(point[2]))
+    return kInvalidKey;
+  auto to_bits = [&](float coordinate) {
+    auto index = static_cast<int64_t>(
+        std::floor(coordinate / parameter_.voxel_size));
+    return static_cast<uint64_t>(index) & kAxisMask;
+  };
+  return to_bits(point[0]) | (to_bits(point[1]) << kAxisBits) |
+         (to_bits(point[2]) << (2 * kAxisBits));
+}
+
+TimedPosition PointCloudIngestor::ToCenter(uint64_t key, double t) const {
+  return {t, ToVoxelCenter(key, parameter_.voxel_size),
+          ToVoxelCenter(key >> kAxisBits, parameter_.voxel_size),
+          ToVoxelCenter(key >> (2 * kAxisBits), parameter_.voxel_size)};
+}
+
+size_t PointCloudIngestor::Downsample(const PointCloudView &cloud) {
+  const size_t num_points = cloud.num_points;
+  const size_t num_chunks = (num_points + kPointsPerChunk - 1) /
+                            kPointsPerChunk;
+  keys_.resize(num_points);
+  merge_buffer_.resize(num_points);
+  chunk_bounds_.resize(num_chunks + 1);
+  auto &bounds = chunk_bounds_;
+  num_merged_ = 0;
+
+  // each chunk sorts and deduplicates its own voxels
+  thread_pool_.ParallelFor(0, num_chunks, 1, [&](size_t chunk) {
+    size_t begin = chunk * kPointsPerChunk;
+    size_t end = std::min(begin + kPointsPerChunk, num_points);
+    for (size_t n = begin; n < end; n++)
+      keys_[n] = ToKey(cloud.GetPoint(n));
+    std::sort(keys_.begin() + begin, keys_.begin() + end);
+    auto unique_end =
+        std::unique(keys_.begin() + begin, keys_.begin() + end);
+    if (unique_end != keys_.begin() + begin && unique_end[-1] == kInvalidKey)
+      --unique_end;
+    // the size for now, turned into offsets below
+    bounds[chunk + 1] = unique_end - (keys_.begin() + begin);
+  });
+
+  // pack the chunks back to back
+  bounds[0] = 0;
+  for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+    size_t size = bounds[chunk + 1];
+    std::copy(keys_.begin() + chunk * kPointsPerChunk,
+              keys_.begin() + chunk * kPointsPerChunk + size,
+              keys_.begin() + bounds[chunk]);
+    bounds[chunk + 1] = bounds[chunk] + size;
+  }
+
+  // merge sorted chunks pairwise in parallel, ping-ponging two buffers
+  uint64_t *source = keys_.data();
+  uint64_t *destination = merge_buffer_.data();
+  for (size_t width = 1; width < num_chunks; width *= 2) {
+    size_t num_pairs = (num_chunks + 2 * width - 1) / (2 * width);
+    thread_pool_.ParallelFor(0, num_pairs, 1, [&](size_t pair) {
+      size_t left = pair * 2 * width;
+      size_t middle = std::min(left + width, num_chunks);
+      size_t right = std::min(left + 2 * width, num_chunks);
+      std::merge(source + bounds[left], source + bounds[middle],
+                 source + bounds[middle], source + bounds[right],
+                 destination + bounds[left]);
+    });
+    std::swap(source, destination);
+  }
+  if (source != keys_.data())
+    keys_.swap(merge_buffer_);
+
+  size_t num_unique = bounds[num_chunks];
+  num_keys_ = std::unique(keys_.begin(), keys_.begin() + num_unique) -
+              keys_.begin();
+  return num_keys_;
+}
+
+bool PointCloudIngestor::MergeSlice(double t) {
+  const size_t slice = std::max<size_t>(parameter_.merge_slice, 1);
+  size_t end = std::min(num_keys_, num_merged_ + slice);
+  for (; num_merged_ < end; num_merged_++) {
+    uint64_t key = keys_[num_merged_];
+    auto observation = observations_.try_emplace(key);
+    if (observation.second)
+      observation.first->second.id =
+          obstacle_manager_.InsertObstacle(ToCenter(key, t));
+    observation.first->second.last_seen = t;
+    expiry_queue_.emplace_back(t, key);
+  }
+
+  const double expiry_time = t - parameter_.window;
+  for (size_t n = 0; n < slice; n++) {
+    if (expiry_queue_.empty() || expiry_queue_.front().first >= expiry_time)
+      return num_merged_ == num_keys_;
+    auto seen = expiry_queue_.front();
+    expiry_queue_.pop_front();
+    auto observation = observations_.find(seen.second);
+    // skip entries of voxels observed again since
+    if (observation == observations_.end() ||
+        observation->second.last_seen != seen.first)
+      continue;
+    obstacle_manager_.RemoveObstacle(observation->second.id);
+    observations_.erase(observation);
+  }
+  return false;
+}
+
+void PointCloudIngestor::Ingest(const PointCloudView &cloud, double t) {
+  Downsample(cloud);
+  while (!MergeSlice(t))
+    ;
+}
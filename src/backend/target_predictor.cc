@@ -0,0 +1,114 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/backend/target_predictor.h"
+
+#include <cmath>
+
+using namespace my_robotics_library;
+using namespace my_robotics_library::backend;
+
+TargetPredictor::TargetPredictor(const TargetPredictorParameter &parameter)
+    : parameter_(parameter) {}
+
+void TargetPredictor::Initialize(const TimedPosition &detection) {
+  const double measurement[3] = {detection.x, detection.y, detection.z};
+  for (int n = 0; n < 3; n++) {
+    axes_[n] = AxisState();
+    axes_[n].position = measurement[n];
+    axes_[n].covariance[0][0] = parameter_.measurement_noise;
+    axes_[n].covariance[1][1] = parameter_.initial_velocity_variance;
+  }
+  t_last_detection_ = detection.t;
+  is_initialized_ = true;
+}
+
+void TargetPredictor::PredictAxis(AxisState &axis, double dt) const {
+  auto &P = axis.covariance;
+  const double q = parameter_.process_noise;
+  axis.position += axis.velocity * dt;
+  // P = F P F' + Q for F = [1 dt; 0 1]
+  double p00 = P[0][0] + dt * (P[0][1] + P[1][0]) + dt * dt * P[1][1];
+  double p01 = P[0][1] + dt * P[1][1];
+  double p11 = P[1][1];
+  P[0][0] = p00 + q * dt * dt * dt / 3;
+  P[0][1] = P[1][0] = p01 + q * dt * dt / 2;
+  P[1][1] = p11 + q * dt;
+}
+
+void TargetPredictor::CorrectAxis(AxisState &axis, double measurement) const {
+  auto &P = axis.covariance;
+  double innovation_variance = P[0][0] + parameter_.measurement_noise;
+  double gain_position = P[0][0] / innovation_variance;
+  double gain_velocity = P[1][0] / innovation_variance;
+  double innovation = measurement - axis.position;
+  axis.position += gain_position * innovation;
+  axis.velocity += gain_velocity * innovation;
+
+  double p00 = (1 - gain_position) * P[0][0];
+  double p01 = (1 - gain_position) * P[0][1];
+  double p11 = P[1][1] - gain_velocity * P[0][1];
+  P[0][0] = p00;
+  P[0][1] = P[1][0] = p01;
+  P[1][1] = p11;
+}
+
+void TargetPredictor::AddDetection(const TimedPosition &detection) {
+  if (!is_initialized_ ||
+      detection.t - t_last_detection_ > parameter_.lost_timeout) {
+    Initialize(detection);
+    return;
+  }
+  double dt = detection.t - t_last_detection_;
+  if (dt <= 0)
+    return;
+
+  const double measurement[3] = {detection.x, detection.y, detection.z};
+  for (int n = 0; n < 3; n++) {
+    PredictAxis(axes_[n], dt);
+    CorrectAxis(axes_[n], measurement[n]);
+  }
+  t_last_detection_ = detection.t;
+}
+
+bool TargetPredictor::HasEstimate(double t) const {
+  return is_initialized_ &&
+         std::abs(t - t_last_detection_) <= parameter_.lost_timeout;
+}
+
+TimedPosition TargetPredictor::PredictPosition(double t) const {
+  double dt = t - t_last_detection_;
+  return {t, axes_[0].position + axes_[0].velocity * dt,
+          axes_[1].position + axes_[1].velocity * dt,
+          axes_[2].position + axes_[2].velocity * dt};
+}
+
+TimedVelocity TargetPredictor::GetVelocity() const {
+  return {t_last_detection_, axes_[0].velocity, axes_[1].velocity,
+          axes_[2].velocity};
+}
+
+TimedPosition TargetPredictor::GetPositionVariance(double t) const {
+  double variance[3];
+  for (int n = 0; n < 3; n++) {
+    AxisState axis = axes_[n];
+    PredictAxis(axis, t - t_last_detection_);
+    variance[n] = axis.covariance[0][0];
+  }
+  return {t, variance[0], variance[1], variance[2]};
+}
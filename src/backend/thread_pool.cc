@@ -0,0 +1,144 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/backend/thread_pool.h"
+#include "chrono"
+
+using namespace my_robotics_library;
+
+// pool and queue owned by this thread, if it is a worker
+static thread_local const ThreadPool *current_pool = nullptr;
+static thread_local size_t current_worker_index = 0;
+
+bool ThreadPool::TaskQueue::PushBack(const Task &task) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (size == kCapacity)
+    return false;
+  tasks[(head + size) % kCapacity] = task;
+  size++;
+  return true;
+}
+
+bool ThreadPool::TaskQueue::PopBack(Task &task) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (size == 0)
+    return false;
+  size--;
+  task = tasks[(head + size) % kCapacity];
+  return true;
+}
+
+bool ThreadPool::TaskQueue::PopFront(Task &task) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (size == 0)
+    return false;
+  task = tasks[head];
+  head = (head + 1) % kCapacity;
+  size--;
+  return true;
+}
+
+ThreadPool::ThreadPool(size_t num_threads) {
+  size_t num_workers = num_threads > 1 ? num_threads - 1 : 0;
+  num_queues_ = num_workers + 1;
+  queues_.reset(new TaskQueue[num_queues_]);
+  workers_.reserve(num_workers);
+  for (size_t n = 0; n < num_workers; n++)
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this, n);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_.store(true);
+  }
+  sleep_condition_.notify_all();
+  for (auto &worker : workers_)
+    worker.join();
+}
+
+size_t ThreadPool::GetLocalQueueIndex() const {
+  return current_pool == this ? current_worker_index : num_queues_ - 1;
+}
+
+void ThreadPool::Push(size_t queue_index, const Task &task) {
+  num_queued_.fetch_add(1, std::memory_order_release);
+  if (!queues_[queue_index].PushBack(task)) {
+    num_queued_.fetch_sub(1, std::memory_order_relaxed);
+    Execute(queue_index, task);
+    return;
+  }
+  sleep_condition_.notify_one();
+}
+
+bool ThreadPool::TryPop(size_t queue_index, Task &task) {
+  if (num_queued_.load(std::memory_order_acquire) == 0)
+    return false;
+  bool is_found = queues_[queue_index].PopBack(task);
+  for (size_t n = 1; !is_found && n < num_queues_; n++)
+    is_found = queues_[(queue_index + n) % num_queues_].PopFront(task);
+  if (is_found)
+    num_queued_.fetch_sub(1, std::memory_order_relaxed);
+  return is_found;
+}
+
+void ThreadPool::Execute(size_t queue_index, Task task) {
+  // keep the lower half, leave upper halves for thieves
+  while (task.end - task.begin > task.job->grain) {
+    size_t middle = task.begin + (task.end - task.begin) / 2;
+    Push(queue_index, {task.job, middle, task.end});
+    task.end = middle;
+  }
+  task.job->invoke(task.job->context, task.begin, task.end);
+  task.job->remaining.fetch_sub(task.end - task.begin,
+                                std::memory_order_acq_rel);
+}
+
+void ThreadPool::Run(Job &job, size_t begin, size_t end) {
+  size_t queue_index = GetLocalQueueIndex();
+  Execute(queue_index, {&job, begin, end});
+  Task task;
+  while (job.remaining.load(std::memory_order_acquire) > 0) {
+    if (TryPop(queue_index, task))
+      Execute(queue_index, task);
+    else
+      std::this_thread::yield();
+  }
+}
+
+void ThreadPool::WorkerLoop(size_t worker_index) {
+  current_pool = this;
+  current_worker_index = worker_index;
+  Task task;
+  while (!stop_.load(std::memory_order_acquire)) {
+    if (TryPop(worker_index, task)) {
+      Execute(worker_index, task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleep_condition_.wait_for(lock, std::chrono::milliseconds(10), [this] {
+      return stop_.load(std::memory_order_acquire) ||
+             num_queued_.load(std::memory_order_acquire) > 0;
+    });
+  }
+}
+
+ThreadPool &my_robotics_library::GetDefaultThreadPool() {
+  static ThreadPool thread_pool;
+  return thread_pool;
+}
@@ -0,0 +1,93 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/control_streamer.h"
+#include "my_robotics_library/frontend/loop_runner.h"
+
+#include <cmath>
+
+using namespace my_robotics_library;
+
+Control my_robotics_library::GenerateControl(
+    MotionPhase phase, const backend::MotionPlanningResultStore &plan,
+    double t) {
+  if (phase == MotionPhase::kIdle)
+    return Control();
+  else if (phase == MotionPhase::kHolding)
+    return Control{MotionPhase::kHolding, 0, 0};
+  else if (phase == MotionPhase::kExploration)
+    return Control{MotionPhase::kExploration, 0, 0};
+  // async plan not ready yet: the plan being served, if any, belongs to the
+  // previous phase and its input means something else
+  else if (!plan.HasValue() || plan.Get()->GetMotionType() != phase)
+    return Control{phase, t, 0};
+  return plan.GenerateControl(t);
+}
+
+ControlStreamer::ControlStreamer(const ControlStreamerOptions &options,
+                                 std::shared_ptr<const Clock> clock)
+    : options_(options), clock_(std::move(clock)),
+      rings_(new ControlRing[options.num_consumers]) {}
+
+ControlStreamer::~ControlStreamer() { Stop(); }
+
+void ControlStreamer::Publish(
+    MotionPhase phase, const backend::MotionPlanningResultStore &plan) {
+  auto &snapshot = snapshots_.GetBackBuffer();
+  snapshot.phase = phase;
+  snapshot.plan = plan;
+  snapshots_.Publish();
+}
+
+bool ControlStreamer::Start() {
+  if (IsRunning())
+    return false;
+  stop_.store(false);
+  thread_ = std::thread([this] {
+    const auto period_ns =
+        static_cast<int64_t>(std::llround(1e9 / options_.frequency));
+    int64_t deadline_ns = GetMonotonicNanoseconds();
+    while (!stop_.load()) {
+      Step();
+      deadline_ns += period_ns;
+      // after a stall, resume on the next period instead of bursting
+      int64_t now_ns = GetMonotonicNanoseconds();
+      if (now_ns > deadline_ns)
+        deadline_ns += (now_ns - deadline_ns) / period_ns * period_ns;
+      SleepUntilMonotonic(deadline_ns);
+    }
+  });
+  return true;
+}
+
+void ControlStreamer::Stop() {
+  stop_.store(true);
+  if (thread_.joinable())
+    thread_.join();
+}
+
+Control ControlStreamer::Step() {
+  const auto &snapshot = snapshots_.Read();
+  auto control = GenerateControl(snapshot.phase, snapshot.plan, clock_->Now());
+  for (size_t consumer = 0; consumer < options_.num_consumers; consumer++)
+    if (!rings_[consumer].TryPush(control))
+      num_dropped_.fetch_add(1, std::memory_order_relaxed);
+  num_samples_.fetch_add(1, std::memory_order_relaxed);
+  return control;
+}
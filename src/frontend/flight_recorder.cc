@@ -0,0 +1,287 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/flight_recorder.h"
+#include "my_robotics_library/frontend/wrapper.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace my_robotics_library;
+
+namespace {
+
+constexpr char kMagic[8] = "MRLFLOG";
+constexpr uint32_t kVersion = 1;
+
+static_assert(sizeof(FlightRecord) == 120, "FlightRecord layout changed");
+static_assert(sizeof(FlightLogHeader) == 64, "FlightLogHeader layout changed");
+static_assert(std::atomic<uint32_t>::is_always_lock_free &&
+                  std::atomic<uint64_t>::is_always_lock_free,
+              "mapped atomics must be lock-free");
+
+void WritePosition(const TimedPosition &position, double *data) {
+  data[0] = position.t;
+  data[1] = position.x;
+  data[2] = position.y;
+  data[3] = position.z;
+}
+
+TimedPosition ReadPosition(const double *data) {
+  return {data[0], data[1], data[2], data[3]};
+}
+
+} // namespace
+
+bool FlightRecorder::Open(const std::string &path, size_t capacity) {
+  Close();
+  int file_descriptor = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (file_descriptor < 0)
+    return false;
+  if (!Map(file_descriptor, capacity)) {
+    close(file_descriptor);
+    return false;
+  }
+  return true;
+}
+
+bool FlightRecorder::OpenInMemory(size_t capacity) {
+  Close();
+  return Map(-1, capacity);
+}
+
+bool FlightRecorder::Map(int file_descriptor, size_t capacity) {
+  size_t mapped_size =
+      sizeof(FlightLogHeader) + capacity * sizeof(FlightRecord);
+  void *mapped;
+  if (file_descriptor < 0) {
+    mapped = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  } else {
+    // reserve the blocks and fault the pages in now rather than mid-flight
+    if (posix_fallocate(file_descriptor, 0, mapped_size) != 0)
+      return false;
+    mapped = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, file_descriptor, 0);
+  }
+  if (mapped == MAP_FAILED)
+    return false;
+  // MAP_POPULATE maps shared pages read-only; take the write faults here
+  const size_t kPageSize = sysconf(_SC_PAGESIZE);
+  for (size_t offset = 0; offset < mapped_size; offset += kPageSize)
+    static_cast<volatile char *>(mapped)[offset] = 0;
+
+  file_descriptor_ = file_descriptor;
+  mapped_size_ = mapped_size;
+  header_ = static_cast<FlightLogHeader *>(mapped);
+  records_ = reinterpret_cast<FlightRecord *>(header_ + 1);
+  std::memcpy(header_->magic, kMagic, sizeof(kMagic));
+  header_->version = kVersion;
+  header_->record_size = sizeof(FlightRecord);
+  header_->capacity = capacity;
+  header_->num_reserved.store(0, std::memory_order_relaxed);
+  header_->num_dropped.store(0, std::memory_order_relaxed);
+  return true;
+}
+
+void FlightRecorder::Close() {
+  if (!header_)
+    return;
+  size_t used_size =
+      sizeof(FlightLogHeader) + GetNumRecords() * sizeof(FlightRecord);
+  munmap(header_, mapped_size_);
+  if (file_descriptor_ >= 0) {
+    if (ftruncate(file_descriptor_, used_size) != 0) {
+      // the log is still readable, only larger than needed
+    }
+    close(file_descriptor_);
+  }
+  file_descriptor_ = -1;
+  mapped_size_ = 0;
+  header_ = nullptr;
+  records_ = nullptr;
+}
+
+size_t FlightRecorder::GetNumRecords() const {
+  if (!header_)
+    return 0;
+  return std::min<uint64_t>(
+      header_->num_reserved.load(std::memory_order_relaxed),
+      header_->capacity);
+}
+
+size_t FlightRecorder::GetNumDropped() const {
+  return header_ ? header_->num_dropped.load(std::memory_order_relaxed) : 0;
+}
+
+FlightRecord *FlightRecorder::Reserve(double t) {
+  if (!header_)
+    return nullptr;
+  uint64_t index =
+      header_->num_reserved.fetch_add(1, std::memory_order_relaxed);
+  if (index >= header_->capacity) {
+    header_->num_dropped.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  auto &record = records_[index];
+  record.t = t;
+  return &record;
+}
+
+void FlightRecorder::Commit(FlightRecord &record, FlightRecordType type) {
+  record.type.store(static_cast<uint32_t>(type), std::memory_order_release);
+}
+
+void FlightRecorder::RecordTimerTick(double t) {
+  if (auto record = Reserve(t))
+    Commit(*record, FlightRecordType::kTimerTick);
+}
+
+void FlightRecorder::RecordCommand(FlightRecordType command, double t) {
+  if (auto record = Reserve(t))
+    Commit(*record, command);
+}
+
+void FlightRecorder::RecordSensor(double t, const SensorInformation &sensor) {
+  auto record = Reserve(t);
+  if (!record)
+    return;
+  record->value = sensor.battery_level;
+  record->previous = sensor.target_position.has_value();
+  WritePosition({sensor.velocity.t, sensor.velocity.x, sensor.velocity.y,
+                 sensor.velocity.z},
+                record->data);
+  WritePosition(sensor.position, record->data + 4);
+  WritePosition(sensor.target_position.value_or(TimedPosition()),
+                record->data + 8);
+  Commit(*record, FlightRecordType::kSensor);
+}
+
+void FlightRecorder::RecordMonitorEvent(double t, MonitorEvent event) {
+  auto record = Reserve(t);
+  if (!record)
+    return;
+  record->value = event;
+  Commit(*record, FlightRecordType::kMonitorEvent);
+}
+
+void FlightRecorder::RecordTransition(double t, MotionPhase from,
+                                      MotionPhase to) {
+  auto record = Reserve(t);
+  if (!record)
+    return;
+  record->value = to;
+  record->previous = from;
+  Commit(*record, FlightRecordType::kTransition);
+}
+
+void FlightRecorder::RecordControl(double t, const Control &control) {
+  auto record = Reserve(t);
+  if (!record)
+    return;
+  record->value = control.phase;
+  record->data[0] = control.t;
+  record->data[1] = control.input;
+  Commit(*record, FlightRecordType::kControl);
+}
+
+void FlightRecorder::RecordPosition(double t, const TimedPosition &position) {
+  auto record = Reserve(t);
+  if (!record)
+    return;
+  WritePosition(position, record->data);
+  Commit(*record, FlightRecordType::kPosition);
+}
+
+bool FlightLogReader::Open(const std::string &path) {
+  Close();
+  int file_descriptor = open(path.c_str(), O_RDONLY);
+  if (file_descriptor < 0)
+    return false;
+  struct stat file_status;
+  if (fstat(file_descriptor, &file_status) != 0 ||
+      static_cast<size_t>(file_status.st_size) < sizeof(FlightLogHeader)) {
+    close(file_descriptor);
+    return false;
+  }
+  size_t mapped_size = file_status.st_size;
+  void *mapped =
+      mmap(nullptr, mapped_size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+  close(file_descriptor);
+  if (mapped == MAP_FAILED)
+    return false;
+
+  auto header = static_cast<const FlightLogHeader *>(mapped);
+  if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+      header->version != kVersion ||
+      header->record_size != sizeof(FlightRecord)) {
+    munmap(mapped, mapped_size);
+    return false;
+  }
+  mapped_ = mapped;
+  mapped_size_ = mapped_size;
+  header_ = header;
+  records_ = reinterpret_cast<const FlightRecord *>(header + 1);
+
+  size_t num_records = std::min<uint64_t>(
+      {header->num_reserved.load(std::memory_order_acquire), header->capacity,
+       (mapped_size - sizeof(FlightLogHeader)) / sizeof(FlightRecord)});
+  num_records_ = 0;
+  while (num_records_ < num_records &&
+         records_[num_records_].GetType() != FlightRecordType::kEmpty)
+    num_records_++;
+  return true;
+}
+
+void FlightLogReader::Close() {
+  if (!mapped_)
+    return;
+  munmap(mapped_, mapped_size_);
+  mapped_ = nullptr;
+  mapped_size_ = 0;
+  header_ = nullptr;
+  records_ = nullptr;
+  num_records_ = 0;
+}
+
+size_t FlightLogReader::GetNumDropped() const {
+  return header_ ? header_->num_dropped.load(std::memory_order_relaxed) : 0;
+}
+
+SensorInformation
+my_robotics_library::ToSensorInformation(const FlightRecord &record) {
+  SensorInformation sensor;
+  auto velocity = ReadPosition(record.data);
+  sensor.velocity = {velocity.t, velocity.x, velocity.y, velocity.z};
+  sensor.position = ReadPosition(record.data + 4);
+  if (record.previous)
+    sensor.target_position = ReadPosition(record.data + 8);
+  sensor.battery_level = record.value;
+  return sensor;
+}
+
+Control my_robotics_library::ToControl(const FlightRecord &record) {
+  return Control{static_cast<MotionPhase>(record.value), record.data[0],
+                 record.data[1]};
+}
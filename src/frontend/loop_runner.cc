@@ -0,0 +1,160 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/loop_runner.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <limits>
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+using namespace my_robotics_library;
+
+int64_t my_robotics_library::GetMonotonicNanoseconds() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+void my_robotics_library::SleepUntilMonotonic(int64_t deadline_ns) {
+  timespec deadline;
+  deadline.tv_sec = deadline_ns / 1000000000;
+  deadline.tv_nsec = deadline_ns % 1000000000;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline,
+                         nullptr) == EINTR)
+    ;
+}
+
+void DurationHistogram::Add(uint64_t duration_ns) {
+  size_t bucket = duration_ns == 0 ? 0 : 64 - __builtin_clzll(duration_ns);
+  buckets_[std::min(bucket, kNumBuckets - 1)]++;
+  num_samples_++;
+  max_ns_ = std::max(max_ns_, duration_ns);
+}
+
+uint64_t DurationHistogram::GetQuantile(double quantile) const {
+  if (num_samples_ == 0)
+    return 0;
+  auto rank = static_cast<uint64_t>(std::ceil(quantile * num_samples_));
+  uint64_t count = 0;
+  for (size_t bucket = 0; bucket < kNumBuckets; bucket++) {
+    count += buckets_[bucket];
+    if (count >= std::max<uint64_t>(rank, 1))
+      return bucket == 0 ? 0 : std::min(max_ns_, (uint64_t{1} << bucket) - 1);
+  }
+  return max_ns_;
+}
+
+LoopRunner::LoopRunner(Wrapper &wrapper, const LoopRunnerOptions &options,
+                       ControlSink control_sink)
+    : wrapper_(wrapper), options_(options),
+      control_sink_(std::move(control_sink)) {}
+
+LoopRunner::~LoopRunner() { Stop(); }
+
+bool LoopRunner::Start() {
+  if (IsRunning())
+    return false;
+  stop_.store(false);
+  thread_ = std::thread([this] {
+    ConfigureThread();
+    Loop(std::numeric_limits<size_t>::max());
+  });
+  return true;
+}
+
+void LoopRunner::Stop() {
+  stop_.store(true);
+  if (thread_.joinable())
+    thread_.join();
+}
+
+void LoopRunner::RunFor(size_t num_ticks) {
+  stop_.store(false);
+  ConfigureThread();
+  Loop(num_ticks);
+}
+
+void LoopRunner::ConfigureThread() {
+#ifdef __linux__
+  if (options_.cpu >= 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(options_.cpu, &cpus);
+    is_pinned_.store(pthread_setaffinity_np(pthread_self(), sizeof(cpus),
+                                            &cpus) == 0);
+  }
+#endif
+  if (options_.realtime_priority > 0) {
+    sched_param parameter{};
+    parameter.sched_priority = options_.realtime_priority;
+    is_realtime_.store(pthread_setschedparam(pthread_self(), SCHED_FIFO,
+                                             &parameter) == 0);
+  }
+}
+
+void LoopRunner::Loop(size_t num_ticks) {
+  const auto period_ns =
+      static_cast<int64_t>(std::llround(1e9 / options_.frequency));
+  const auto degrade_ns =
+      static_cast<int64_t>(options_.degrade_threshold * period_ns);
+  LoopStatistics statistics = statistics_.Load();
+  bool is_degraded = false;
+
+  int64_t deadline_ns = GetMonotonicNanoseconds() + period_ns;
+  for (size_t tick = 0; tick < num_ticks && !stop_.load(); tick++) {
+    SleepUntilMonotonic(deadline_ns);
+    int64_t wake_ns = GetMonotonicNanoseconds();
+    statistics.jitter.Add(std::max<int64_t>(0, wake_ns - deadline_ns));
+
+    if (options_.degrade_policy == DegradePolicy::kSkipLookahead) {
+      wrapper_.SetDegraded(is_degraded);
+      statistics.num_degraded_ticks += is_degraded;
+    }
+    wrapper_.OnTimerCallback();
+    auto control = wrapper_.GetControl();
+    if (control_sink_)
+      control_sink_(control);
+
+    int64_t end_ns = GetMonotonicNanoseconds();
+    statistics.execution.Add(end_ns - wake_ns);
+    statistics.num_ticks++;
+
+    int64_t used_ns = end_ns - deadline_ns;
+    if (used_ns > degrade_ns)
+      is_degraded = true;
+    else if (used_ns < degrade_ns / 2)
+      is_degraded = false;
+
+    deadline_ns += period_ns;
+    if (end_ns > deadline_ns) {
+      statistics.num_overruns++;
+      int64_t num_missed = (end_ns - deadline_ns) / period_ns + 1;
+      statistics.num_skipped_periods += num_missed;
+      deadline_ns += num_missed * period_ns;
+    }
+    statistics_.Store(statistics);
+  }
+  if (options_.degrade_policy == DegradePolicy::kSkipLookahead)
+    wrapper_.SetDegraded(false);
+}
@@ -0,0 +1,222 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/mission_simulator.h"
+#include "my_robotics_library/frontend/wrapper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+
+using namespace my_robotics_library;
+
+namespace {
+
+constexpr size_t kEpisodesPerChunk = 16;
+
+uint64_t SplitMix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+double Uniform(std::mt19937_64 &random, double low, double high) {
+  return std::uniform_real_distribution<double>(low, high)(random);
+}
+
+double Clamp(double value, double limit) {
+  return std::max(-limit, std::min(limit, value));
+}
+
+void Accumulate(const EpisodeResult &episode, MissionStatistics &sum) {
+  sum.num_episodes++;
+  for (size_t phase = 0; phase < kNumMotionPhases; phase++)
+    sum.mean_time_in_phase[phase] += episode.time_in_phase[phase];
+  sum.landing_rate += episode.has_landed;
+  sum.mean_flight_time += episode.flight_time;
+  sum.mean_hold_stops += episode.num_hold_stops;
+  sum.mean_target_losses += episode.num_target_losses;
+  sum.mean_chasing_plans += episode.num_chasing_plans;
+  sum.hold_stop_rate += episode.num_hold_stops > 0;
+}
+
+void Merge(const MissionStatistics &partial, MissionStatistics &sum) {
+  sum.num_episodes += partial.num_episodes;
+  for (size_t phase = 0; phase < kNumMotionPhases; phase++)
+    sum.mean_time_in_phase[phase] += partial.mean_time_in_phase[phase];
+  sum.landing_rate += partial.landing_rate;
+  sum.mean_flight_time += partial.mean_flight_time;
+  sum.mean_hold_stops += partial.mean_hold_stops;
+  sum.mean_target_losses += partial.mean_target_losses;
+  sum.mean_chasing_plans += partial.mean_chasing_plans;
+  sum.hold_stop_rate += partial.hold_stop_rate;
+}
+
+} // namespace
+
+EpisodeResult my_robotics_library::SimulateEpisode(
+    const MissionSimulatorOptions &options, uint64_t episode) {
+  const auto &scenario = options.scenario;
+  std::mt19937_64 random(SplitMix64(options.seed ^ SplitMix64(episode)));
+
+  // a worker thread would make the timing of plans nondeterministic
+  auto parameter = options.parameter;
+  parameter.use_async_chasing_planner = false;
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(parameter, clock);
+
+  int num_obstacles = std::uniform_int_distribution<int>(
+      scenario.min_num_obstacles, scenario.max_num_obstacles)(random);
+  for (int n = 0; n < num_obstacles; n++) {
+    TimedPosition obstacle;
+    obstacle.x = Uniform(random, 1.0, scenario.obstacle_field_length);
+    obstacle.y = Uniform(random, -0.5, 0.5) * scenario.obstacle_field_width;
+    obstacle.z = Uniform(random, 0.0, scenario.obstacle_field_height);
+    wrapper.GetObstacleManager().InsertObstacle(obstacle);
+  }
+
+  TimedPosition target_start;
+  target_start.x = Uniform(random, scenario.min_target_distance,
+                           scenario.max_target_distance);
+  target_start.y = Uniform(random, -1.0, 1.0);
+  double target_speed = Uniform(random, 0.0, scenario.max_target_speed);
+  double target_heading = Uniform(random, -M_PI / 4, M_PI / 4);
+  double battery_drain = Uniform(random, scenario.min_battery_drain,
+                                 scenario.max_battery_drain);
+
+  EpisodeResult result;
+  const double dt = scenario.tick_period;
+  const size_t num_ticks =
+      static_cast<size_t>(std::round(scenario.duration / dt));
+  const size_t chase_command_tick =
+      static_cast<size_t>(std::round(scenario.chase_command_time / dt));
+  TimedPosition position;
+  TimedVelocity velocity;
+  double battery_charge = 100.0;
+  auto phase = wrapper.GetStateHistory().Back().motion_phase;
+  double chasing_plan_time = -1.0;
+
+  for (size_t tick = 0; tick < num_ticks; tick++) {
+    // the wrapper pushed its initial state at t = 0
+    double t = (tick + 1) * dt;
+    clock->SetTime(t);
+    position.t = t;
+    velocity.t = t;
+    wrapper.SetPosition(position);
+    wrapper.SetVelocity(velocity);
+
+    TimedPosition target{t,
+                         target_start.x + target_speed * t *
+                                              std::cos(target_heading),
+                         target_start.y + target_speed * t *
+                                              std::sin(target_heading),
+                         0.0};
+    double target_distance = std::hypot(target.x - position.x,
+                                        target.y - position.y,
+                                        target.z - position.z);
+    bool is_detected = target_distance < scenario.sensing_range &&
+                       Uniform(random, 0.0, 1.0) >=
+                           scenario.detection_dropout;
+    wrapper.SetTargetPosition(is_detected ? std::optional<TimedPosition>(target)
+                                          : std::nullopt);
+    wrapper.SetBatteryLevel(static_cast<int>(std::ceil(battery_charge)));
+
+    if (tick == 0)
+      wrapper.PostHoveringCommand();
+    if (tick == chase_command_tick)
+      wrapper.PostChasingCommand();
+    wrapper.OnTimerCallback();
+
+    wrapper.GetStateHistory().ForEachSince(
+        t - dt / 2, [&](const TimedState &timed_state) {
+          auto next_phase = timed_state.state.motion_phase;
+          if (next_phase == MotionPhase::kHolding &&
+              phase != MotionPhase::kHolding)
+            result.num_hold_stops++;
+          if (phase == MotionPhase::kChasing &&
+              next_phase == MotionPhase::kExploration)
+            result.num_target_losses++;
+          phase = next_phase;
+        });
+    auto plan = wrapper.GetMotionPlanningResult().Get();
+    if (plan && plan->GetMotionType() == MotionPhase::kChasing &&
+        plan->GetRequestTime() != chasing_plan_time) {
+      chasing_plan_time = plan->GetRequestTime();
+      result.num_chasing_plans++;
+    }
+
+    // kinematic vehicle following the control of the current phase
+    auto control = wrapper.GetControl();
+    velocity = TimedVelocity();
+    if (phase == MotionPhase::kHovering)
+      velocity.z = std::min(scenario.position_gain * control.input,
+                            scenario.max_speed);
+    else if (phase == MotionPhase::kLanding)
+      velocity.z = -scenario.landing_speed;
+    else if (phase == MotionPhase::kChasing)
+      velocity.x = Clamp(scenario.position_gain * (control.input - position.x),
+                         scenario.max_speed);
+    position.x += velocity.x * dt;
+    position.y += velocity.y * dt;
+    position.z += velocity.z * dt;
+
+    result.time_in_phase[phase] += dt;
+    result.flight_time = t;
+    battery_charge = std::max(0.0, battery_charge - battery_drain * dt);
+
+    if (phase == MotionPhase::kLanding && position.z <= 0.0) {
+      result.has_landed = true;
+      break;
+    }
+  }
+  return result;
+}
+
+MissionStatistics
+my_robotics_library::SimulateMissions(const MissionSimulatorOptions &options,
+                                      size_t num_episodes,
+                                      ThreadPool &thread_pool) {
+  // fixed chunks summed in order keep the result independent of scheduling
+  size_t num_chunks = (num_episodes + kEpisodesPerChunk - 1) /
+                      kEpisodesPerChunk;
+  std::vector<MissionStatistics> partials(num_chunks);
+  thread_pool.ParallelFor(0, num_chunks, 1, [&](size_t chunk) {
+    size_t end = std::min((chunk + 1) * kEpisodesPerChunk, num_episodes);
+    for (size_t episode = chunk * kEpisodesPerChunk; episode < end; episode++)
+      Accumulate(SimulateEpisode(options, episode), partials[chunk]);
+  });
+
+  MissionStatistics statistics;
+  for (const auto &partial : partials)
+    Merge(partial, statistics);
+  if (statistics.num_episodes == 0)
+    return statistics;
+  double scale = 1.0 / statistics.num_episodes;
+  for (auto &time : statistics.mean_time_in_phase)
+    time *= scale;
+  statistics.landing_rate *= scale;
+  statistics.mean_flight_time *= scale;
+  statistics.mean_hold_stops *= scale;
+  statistics.mean_target_losses *= scale;
+  statistics.mean_chasing_plans *= scale;
+  statistics.hold_stop_rate *= scale;
+  return statistics;
+}
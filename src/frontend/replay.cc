@@ -0,0 +1,181 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/replay.h"
+
+#include <cmath>
+
+using namespace my_robotics_library;
+
+namespace {
+
+bool IsDecision(const FlightRecord &record) {
+  auto type = record.GetType();
+  return type == FlightRecordType::kTransition ||
+         type == FlightRecordType::kControl;
+}
+
+ReplayDecision ToDecision(const FlightRecord &record) {
+  ReplayDecision decision;
+  decision.type = record.GetType();
+  decision.t = record.t;
+  decision.phase = static_cast<MotionPhase>(record.value);
+  if (decision.type == FlightRecordType::kControl)
+    decision.input = ToControl(record).input;
+  return decision;
+}
+
+// Records written by threads other than the control thread, which may land
+// between a callback and the snapshot it read
+bool IsFromOtherThread(const FlightRecord &record) {
+  auto type = record.GetType();
+  return type == FlightRecordType::kPosition ||
+         type == FlightRecordType::kPostedHoveringCommand ||
+         type == FlightRecordType::kPostedChasingCommand;
+}
+
+bool IsSameDecision(const ReplayDecision &expected,
+                    const ReplayDecision &actual, double tolerance) {
+  return expected.type == actual.type && expected.t == actual.t &&
+         expected.phase == actual.phase &&
+         std::abs(expected.input - actual.input) <= tolerance;
+}
+
+// Walks the decisions of two record sequences in lockstep
+template <typename Baseline, typename Replayed>
+void CompareDecisions(const Baseline &baseline, size_t baseline_size,
+                      const Replayed &replayed, size_t replayed_size,
+                      double tolerance, ReplayResult &result) {
+  size_t i = 0, j = 0;
+  while (true) {
+    while (i < baseline_size && !IsDecision(baseline[i]))
+      i++;
+    while (j < replayed_size && !IsDecision(replayed[j]))
+      j++;
+    if (i == baseline_size && j == replayed_size)
+      return;
+
+    ReplayDecision expected, actual;
+    if (i < baseline_size)
+      expected = ToDecision(baseline[i++]);
+    if (j < replayed_size)
+      actual = ToDecision(replayed[j++]);
+    if (!IsSameDecision(expected, actual, tolerance)) {
+      result.is_diverged = true;
+      result.divergence_index = result.num_compared;
+      result.expected = expected;
+      result.actual = actual;
+      return;
+    }
+    result.num_compared++;
+  }
+}
+
+} // namespace
+
+ReplayResult my_robotics_library::ReplayFlightLog(
+    const FlightLogReader &baseline, const ReplayOptions &options) {
+  ReplayResult result;
+  result.is_loaded = true;
+
+  auto clock = std::make_shared<SimulatedClock>();
+  auto parameter = options.parameter;
+  parameter.use_async_chasing_planner = false;
+  Wrapper wrapper(parameter, clock);
+  if (options.setup)
+    options.setup(wrapper);
+
+  // a faithful replay emits about as many records as it consumes, plus one
+  // position record per callback
+  FlightRecorder replayed;
+  if (!replayed.OpenInMemory(2 * baseline.Size() + 64)) {
+    result.is_loaded = false;
+    return result;
+  }
+  wrapper.SetFlightRecorder(&replayed);
+
+  for (size_t n = 0; n < baseline.Size(); n++) {
+    const auto &record = baseline[n];
+    auto type = record.GetType();
+    if (type == FlightRecordType::kControl) {
+      clock->SetTime(record.t);
+      wrapper.GetControl();
+      continue;
+    }
+    if (type == FlightRecordType::kPostedHoveringCommand ||
+        type == FlightRecordType::kPostedChasingCommand) {
+      clock->SetTime(record.t);
+      if (type == FlightRecordType::kPostedHoveringCommand)
+        wrapper.PostHoveringCommand();
+      else
+        wrapper.PostChasingCommand();
+      continue;
+    }
+    if (type == FlightRecordType::kPosition) {
+      clock->SetTime(record.t);
+      wrapper.SetPosition({record.data[0], record.data[1], record.data[2],
+                           record.data[3]});
+      continue;
+    }
+    if (type != FlightRecordType::kTimerTick &&
+        type != FlightRecordType::kHoveringCommand &&
+        type != FlightRecordType::kChasingCommand)
+      continue;
+
+    // the callback reads the snapshot recorded after it; records of other
+    // threads in between are replayed in order once the callback ran
+    clock->SetTime(record.t);
+    size_t snapshot = n + 1;
+    while (snapshot < baseline.Size() && IsFromOtherThread(baseline[snapshot]))
+      snapshot++;
+    if (snapshot < baseline.Size() &&
+        baseline[snapshot].GetType() == FlightRecordType::kSensor) {
+      auto sensor = ToSensorInformation(baseline[snapshot]);
+      wrapper.SetVelocity(sensor.velocity);
+      wrapper.SetPosition(sensor.position);
+      wrapper.SetTargetPosition(sensor.target_position);
+      wrapper.SetBatteryLevel(sensor.battery_level);
+    }
+    if (type == FlightRecordType::kTimerTick)
+      wrapper.OnTimerCallback();
+    else if (type == FlightRecordType::kHoveringCommand)
+      wrapper.OnHoveringCommandCallback();
+    else
+      wrapper.OnChasingCommandCallback();
+    result.num_callbacks++;
+  }
+
+  CompareDecisions(baseline, baseline.Size(), replayed,
+                   replayed.GetNumRecords(), options.control_tolerance,
+                   result);
+  return result;
+}
+
+std::vector<ReplayResult>
+my_robotics_library::ReplayFlightLogs(const std::vector<std::string> &paths,
+                                      const ReplayOptions &options,
+                                      ThreadPool &thread_pool) {
+  std::vector<ReplayResult> results(paths.size());
+  thread_pool.ParallelFor(0, paths.size(), 1, [&](size_t index) {
+    FlightLogReader baseline;
+    if (baseline.Open(paths[index]))
+      results[index] = ReplayFlightLog(baseline, options);
+  });
+  return results;
+}
@@ -0,0 +1,318 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/frontend/shared_memory_transport.h"
+#include "my_robotics_library/frontend/wrapper.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+using namespace my_robotics_library;
+
+static_assert(sizeof(SensorMessage) == 40, "SensorMessage layout changed");
+static_assert(sizeof(WrapperOutputMessage) == 32,
+              "WrapperOutputMessage layout changed");
+static_assert(std::is_trivially_copyable<SensorMessage>::value &&
+                  std::is_trivially_copyable<WrapperOutputMessage>::value,
+              "messages are copied between processes");
+// the ring indices are shared between processes, which only works for
+// address-free atomics
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory rings require lock-free atomics");
+
+namespace {
+constexpr char kMagic[8] = {'M', 'R', 'L', 'S', 'H', 'M', '0', '1'};
+constexpr uint32_t kVersion = 2;
+} // namespace
+
+struct SharedMemoryChannel::Segment {
+  char magic[8];
+  // written last by the creator, so an opener never sees half-built rings
+  std::atomic<uint32_t> version;
+  uint32_t segment_size;
+  // tells a stale segment from one still served by a running process
+  pid_t creator_pid;
+  SensorRing sensor_ring;
+  OutputRing output_ring;
+};
+
+static_assert(std::is_trivially_destructible<
+                  SharedMemoryChannel::SensorRing>::value &&
+                  std::is_trivially_destructible<
+                      SharedMemoryChannel::OutputRing>::value,
+              "the segment is unmapped without running destructors");
+
+namespace {
+void *MapSegment(int file_descriptor, size_t size) {
+  void *mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, file_descriptor, 0);
+  return mapped == MAP_FAILED ? nullptr : mapped;
+}
+} // namespace
+
+bool SharedMemoryChannel::Create(const std::string &name) {
+  Close();
+  int file_descriptor =
+      shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (file_descriptor < 0 && errno == EEXIST && RemoveIfStale(name))
+    file_descriptor = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (file_descriptor < 0)
+    return false;
+  void *mapped = nullptr;
+  if (ftruncate(file_descriptor, sizeof(Segment)) == 0)
+    mapped = MapSegment(file_descriptor, sizeof(Segment));
+  // the mapping keeps the segment alive
+  close(file_descriptor);
+  if (!mapped) {
+    shm_unlink(name.c_str());
+    return false;
+  }
+
+  segment_ = new (mapped) Segment;
+  std::memcpy(segment_->magic, kMagic, sizeof(kMagic));
+  segment_->segment_size = sizeof(Segment);
+  segment_->creator_pid = getpid();
+  segment_->version.store(kVersion, std::memory_order_release);
+  name_ = name;
+  is_creator_ = true;
+  return true;
+}
+
+bool SharedMemoryChannel::Open(const std::string &name) {
+  Close();
+  Segment *segment = MapExisting(name);
+  if (!segment)
+    return false;
+  segment_ = segment;
+  name_ = name;
+  is_creator_ = false;
+  return true;
+}
+
+SharedMemoryChannel::Segment *
+SharedMemoryChannel::MapExisting(const std::string &name) {
+  int file_descriptor = shm_open(name.c_str(), O_RDWR, 0);
+  if (file_descriptor < 0)
+    return nullptr;
+  struct stat status;
+  void *mapped = nullptr;
+  if (fstat(file_descriptor, &status) == 0 &&
+      static_cast<size_t>(status.st_size) == sizeof(Segment))
+    mapped = MapSegment(file_descriptor, sizeof(Segment));
+  close(file_descriptor);
+  if (!mapped)
+    return nullptr;
+
+  auto segment = static_cast<Segment *>(mapped);
+  if (segment->version.load(std::memory_order_acquire) != kVersion ||
+      std::memcmp(segment->magic, kMagic, sizeof(kMagic)) != 0 ||
+      segment->segment_size != sizeof(Segment)) {
+    munmap(mapped, sizeof(Segment));
+    return nullptr;
+  }
+  return segment;
+}
+
+bool SharedMemoryChannel::RemoveIfStale(const std::string &name) {
+  // a segment that cannot be read may still be in use, so it is kept
+  Segment *segment = MapExisting(name);
+  if (!segment)
+    return false;
+  pid_t creator_pid = segment->creator_pid;
+  munmap(segment, sizeof(Segment));
+  // EPERM means the creator runs under another user
+  if (kill(creator_pid, 0) == 0 || errno != ESRCH)
+    return false;
+  return shm_unlink(name.c_str()) == 0;
+}
+
+void SharedMemoryChannel::Close() {
+  if (!segment_)
+    return;
+  munmap(segment_, sizeof(Segment));
+  if (is_creator_)
+    shm_unlink(name_.c_str());
+  segment_ = nullptr;
+  name_.clear();
+  is_creator_ = false;
+}
+
+SharedMemoryChannel::SensorRing &SharedMemoryChannel::GetSensorRing() {
+  return segment_->sensor_ring;
+}
+
+SharedMemoryChannel::OutputRing &SharedMemoryChannel::GetOutputRing() {
+  return segment_->output_ring;
+}
+
+namespace {
+template <typename Timed>
+SensorMessage MakeMessage(SensorMessageType type, const Timed &value) {
+  SensorMessage message;
+  message.type = type;
+  message.data[0] = value.t;
+  message.data[1] = value.x;
+  message.data[2] = value.y;
+  message.data[3] = value.z;
+  return message;
+}
+
+template <typename Timed> Timed ReadMessage(const SensorMessage &message) {
+  Timed value;
+  value.t = message.data[0];
+  value.x = message.data[1];
+  value.y = message.data[2];
+  value.z = message.data[3];
+  return value;
+}
+
+SensorMessage MakeMessage(SensorMessageType type) {
+  SensorMessage message;
+  message.type = type;
+  return message;
+}
+} // namespace
+
+bool SharedMemoryClient::SendVelocity(const TimedVelocity &velocity) {
+  return Send(MakeMessage(SensorMessageType::kVelocity, velocity));
+}
+
+bool SharedMemoryClient::SendPosition(const TimedPosition &position) {
+  return Send(MakeMessage(SensorMessageType::kPosition, position));
+}
+
+bool SharedMemoryClient::SendTargetPosition(
+    const TimedPosition &target_position) {
+  return Send(
+      MakeMessage(SensorMessageType::kTargetPosition, target_position));
+}
+
+bool SharedMemoryClient::SendTargetLost() {
+  return Send(MakeMessage(SensorMessageType::kTargetLost));
+}
+
+bool SharedMemoryClient::SendBatteryLevel(int level) {
+  auto message = MakeMessage(SensorMessageType::kBatteryLevel);
+  message.battery_level = level;
+  return Send(message);
+}
+
+bool SharedMemoryClient::SendHoveringCommand() {
+  return Send(MakeMessage(SensorMessageType::kHoveringCommand));
+}
+
+bool SharedMemoryClient::SendChasingCommand() {
+  return Send(MakeMessage(SensorMessageType::kChasingCommand));
+}
+
+bool SharedMemoryClient::Send(const SensorMessage &message) {
+  return channel_.GetSensorRing().TryPush(message);
+}
+
+bool SharedMemoryClient::Receive(WrapperOutputMessage &message) {
+  return channel_.GetOutputRing().TryPop(message);
+}
+
+SharedMemoryWrapperAdaptor::SharedMemoryWrapperAdaptor(
+    Wrapper &wrapper, SharedMemoryChannel &channel)
+    : wrapper_(wrapper), channel_(channel),
+      num_published_transitions_(wrapper.GetStateHistory().GetNumPushed()),
+      last_published_phase_(wrapper.GetStateHistory().Back().motion_phase) {}
+
+size_t SharedMemoryWrapperAdaptor::Poll() {
+  SensorMessage message;
+  size_t num_messages = 0;
+  while (channel_.GetSensorRing().TryPop(message)) {
+    num_messages++;
+    switch (message.type) {
+    case SensorMessageType::kVelocity:
+      wrapper_.SetVelocity(ReadMessage<TimedVelocity>(message));
+      break;
+    case SensorMessageType::kPosition:
+      wrapper_.SetPosition(ReadMessage<TimedPosition>(message));
+      break;
+    case SensorMessageType::kTargetPosition:
+      wrapper_.SetTargetPosition(ReadMessage<TimedPosition>(message));
+      break;
+    case SensorMessageType::kTargetLost:
+      wrapper_.SetTargetPosition(std::nullopt);
+      break;
+    case SensorMessageType::kBatteryLevel:
+      wrapper_.SetBatteryLevel(message.battery_level);
+      break;
+    case SensorMessageType::kHoveringCommand:
+      wrapper_.PostHoveringCommand();
+      break;
+    case SensorMessageType::kChasingCommand:
+      wrapper_.PostChasingCommand();
+      break;
+    }
+  }
+  return num_messages;
+}
+
+void SharedMemoryWrapperAdaptor::Publish() {
+  const StateHistory &history = wrapper_.GetStateHistory();
+  uint64_t num_pushed = history.GetNumPushed();
+  if (num_pushed < num_published_transitions_) // history was cleared
+    num_published_transitions_ = 0;
+  // transitions already overwritten in the history are lost
+  size_t num_new = std::min<uint64_t>(num_pushed - num_published_transitions_,
+                                      history.Size());
+  for (size_t i = history.Size() - num_new; i < history.Size(); i++) {
+    const TimedState &timed_state = history.At(i);
+    WrapperOutputMessage message;
+    message.type = WrapperOutputType::kTransition;
+    message.phase = timed_state.state.motion_phase;
+    message.previous = last_published_phase_;
+    message.t = timed_state.t;
+    Push(message);
+    last_published_phase_ = timed_state.state.motion_phase;
+  }
+  num_published_transitions_ = num_pushed;
+
+  Control control = wrapper_.GetControl();
+  WrapperOutputMessage message;
+  message.type = WrapperOutputType::kControl;
+  message.phase = control.phase;
+  message.t = control.t;
+  message.input = control.input;
+  Push(message);
+}
+
+void SharedMemoryWrapperAdaptor::Step() {
+  Poll();
+  wrapper_.OnTimerCallback();
+  Publish();
+}
+
+void SharedMemoryWrapperAdaptor::Push(const WrapperOutputMessage &message) {
+  if (!channel_.GetOutputRing().TryPush(message))
+    num_dropped_++;
+}
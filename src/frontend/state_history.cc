@@ -0,0 +1,59 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/frontend/state_history.h"
+
+using namespace my_robotics_library;
+
+void StateHistory::Push(const State &state, double t) {
+  num_pushed_++;
+  if (size_ < kCapacity) {
+    buffer_[(head_ + size_) % kCapacity] = {t, state};
+    size_++;
+    return;
+  }
+  buffer_[head_] = {t, state};
+  head_ = (head_ + 1) % kCapacity;
+}
+
+void StateHistory::Clear() {
+  head_ = 0;
+  size_ = 0;
+  num_pushed_ = 0;
+}
+
+const TimedState &StateHistory::At(size_t index) const {
+  return buffer_[(head_ + index) % kCapacity];
+}
+
+size_t StateHistory::CountSince(double t) const {
+  return size_ - FirstIndexAfter(t);
+}
+
+size_t StateHistory::FirstIndexAfter(double t) const {
+  // binary search over the logical (oldest-first) order
+  size_t low = 0, high = size_;
+  while (low < high) {
+    size_t mid = (low + high) / 2;
+    if (At(mid).t > t)
+      high = mid;
+    else
+      low = mid + 1;
+  }
+  return low;
+}
@@ -0,0 +1,327 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/tracing.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace my_robotics_library;
+
+namespace {
+
+constexpr size_t kNumStages = static_cast<size_t>(TraceStage::kNumStages);
+constexpr size_t kNumEvents = kNumMonitorEvents;
+constexpr size_t kNumPhases = kNumMotionPhases;
+
+const char *kEventNames[kNumEvents] = {
+    "kHover",       "kLand",         "kHoldStop",     "kExplore",
+    "kChaseReplan", "kHoverCommand", "kChaseCommand", "kNone"};
+const char *kPhaseNames[kNumPhases] = {"kLanding", "kHolding", "kExploration",
+                                       "kChasing", "kHovering", "kIdle"};
+
+struct TraceRecord {
+  uint64_t begin_ns;
+  uint32_t duration_ns;
+  uint32_t stage;
+};
+
+struct StageCounters {
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> total_ns{0};
+  std::atomic<uint64_t> max_ns{0};
+};
+
+// Counters are only written by the owning thread, so a relaxed load and
+// store is enough for the dumping thread to read whole values.
+void Add(std::atomic<uint64_t> &counter, uint64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value,
+                std::memory_order_relaxed);
+}
+
+struct ThreadBuffer {
+  uint32_t thread_index{0};
+  std::unique_ptr<TraceRecord[]> records{
+      new TraceRecord[Tracer::kRecordCapacity]};
+  std::atomic<uint64_t> num_records{0}; // total, including overwritten
+  std::array<StageCounters, kNumStages> stages;
+  std::array<std::atomic<uint64_t>, kNumEvents> events{};
+  std::array<std::atomic<uint64_t>, kNumPhases * kNumPhases> transitions{};
+};
+
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+// buffers of exited threads, guarded by registry_mutex
+std::vector<ThreadBuffer *> free_buffers;
+
+thread_local ThreadBuffer *local_buffer = nullptr;
+
+// Hands the buffer of an exiting thread, records and counters included, to
+// the next thread that starts tracing
+struct BufferRelease {
+  ~BufferRelease() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    free_buffers.push_back(local_buffer);
+    local_buffer = nullptr;
+  }
+};
+
+ThreadBuffer &GetLocalBuffer() {
+  if (!local_buffer) {
+    {
+      std::lock_guard<std::mutex> lock(registry_mutex);
+      if (!free_buffers.empty()) {
+        local_buffer = free_buffers.back();
+        free_buffers.pop_back();
+      } else {
+        registry.emplace_back(new ThreadBuffer);
+        local_buffer = registry.back().get();
+        local_buffer->thread_index = registry.size() - 1;
+      }
+    }
+    thread_local BufferRelease release;
+  }
+  return *local_buffer;
+}
+
+template <typename Function> void ForEachBuffer(Function &&function) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (const auto &buffer : registry)
+    function(*buffer);
+}
+
+// records still held by the ring, oldest first
+template <typename Function>
+void ForEachRecord(const ThreadBuffer &buffer, Function &&function) {
+  uint64_t num_records = buffer.num_records.load(std::memory_order_acquire);
+  uint64_t first = num_records > Tracer::kRecordCapacity
+                       ? num_records - Tracer::kRecordCapacity
+                       : 0;
+  for (uint64_t n = first; n < num_records; n++)
+    function(buffer.records[n % Tracer::kRecordCapacity]);
+}
+
+} // namespace
+
+uint64_t Tracer::NowNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Tracer::RecordStage(TraceStage stage, uint64_t begin_ns,
+                         uint64_t end_ns) {
+  auto &buffer = GetLocalBuffer();
+  uint64_t duration_ns = end_ns - begin_ns;
+  uint64_t index = buffer.num_records.load(std::memory_order_relaxed);
+  buffer.records[index % kRecordCapacity] = {
+      begin_ns, static_cast<uint32_t>(duration_ns),
+      static_cast<uint32_t>(stage)};
+  buffer.num_records.store(index + 1, std::memory_order_release);
+
+  auto &counters = buffer.stages[static_cast<size_t>(stage)];
+  Add(counters.count, 1);
+  Add(counters.total_ns, duration_ns);
+  if (duration_ns > counters.max_ns.load(std::memory_order_relaxed))
+    counters.max_ns.store(duration_ns, std::memory_order_relaxed);
+}
+
+void Tracer::CountEvent(MonitorEvent event) {
+  Add(GetLocalBuffer().events[event], 1);
+}
+
+void Tracer::CountTransition(MotionPhase from, MotionPhase to) {
+  Add(GetLocalBuffer().transitions[from * kNumPhases + to], 1);
+}
+
+TraceStageStatistics Tracer::GetStageStatistics(TraceStage stage) {
+  TraceStageStatistics statistics;
+  ForEachBuffer([&](const ThreadBuffer &buffer) {
+    const auto &counters = buffer.stages[static_cast<size_t>(stage)];
+    statistics.count += counters.count.load(std::memory_order_relaxed);
+    statistics.total_ns += counters.total_ns.load(std::memory_order_relaxed);
+    statistics.max_ns = std::max(
+        statistics.max_ns, counters.max_ns.load(std::memory_order_relaxed));
+  });
+  return statistics;
+}
+
+uint64_t Tracer::GetEventCount(MonitorEvent event) {
+  uint64_t count = 0;
+  ForEachBuffer([&](const ThreadBuffer &buffer) {
+    count += buffer.events[event].load(std::memory_order_relaxed);
+  });
+  return count;
+}
+
+uint64_t Tracer::GetTransitionCount(MotionPhase from, MotionPhase to) {
+  uint64_t count = 0;
+  ForEachBuffer([&](const ThreadBuffer &buffer) {
+    count += buffer.transitions[from * kNumPhases + to].load(
+        std::memory_order_relaxed);
+  });
+  return count;
+}
+
+void Tracer::Reset() {
+  ForEachBuffer([](ThreadBuffer &buffer) {
+    buffer.num_records.store(0, std::memory_order_relaxed);
+    for (auto &counters : buffer.stages) {
+      counters.count.store(0, std::memory_order_relaxed);
+      counters.total_ns.store(0, std::memory_order_relaxed);
+      counters.max_ns.store(0, std::memory_order_relaxed);
+    }
+    for (auto &count : buffer.events)
+      count.store(0, std::memory_order_relaxed);
+    for (auto &count : buffer.transitions)
+      count.store(0, std::memory_order_relaxed);
+  });
+}
+
+const char *Tracer::GetStageName(TraceStage stage) {
+  static const char *kStageNames[kNumStages] = {
+      "TimerTick",         "HoveringCommand", "ChasingCommand",
+      "GetControl",        "ReadSensorSnapshot", "UpdateMonitor",
+      "ReadMonitorEvent",  "HandleHovering",  "HandleLanding",
+      "HandleChasingPlan", "Planning"};
+  return kStageNames[static_cast<size_t>(stage)];
+}
+
+bool Tracer::WriteChromeTrace(const std::string &path) {
+  std::ofstream file(path);
+  if (!file)
+    return false;
+
+  file << "{\"traceEvents\":[\n";
+  bool is_first = true;
+  uint64_t last_ns = 0;
+  auto separator = [&]() -> const char * {
+    const char *text = is_first ? "" : ",\n";
+    is_first = false;
+    return text;
+  };
+  ForEachBuffer([&](const ThreadBuffer &buffer) {
+    ForEachRecord(buffer, [&](const TraceRecord &record) {
+      file << separator() << "{\"name\":\""
+           << GetStageName(static_cast<TraceStage>(record.stage))
+           << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer.thread_index
+           << ",\"ts\":" << record.begin_ns / 1e3
+           << ",\"dur\":" << record.duration_ns / 1e3 << "}";
+      last_ns = std::max(last_ns, record.begin_ns + record.duration_ns);
+    });
+  });
+
+  // counters as of the end of the trace
+  file << separator() << "{\"name\":\"MonitorEvent\",\"ph\":\"C\",\"pid\":0,"
+       << "\"ts\":" << last_ns / 1e3 << ",\"args\":{";
+  for (size_t event = 0; event < kNumEvents; event++)
+    file << (event ? "," : "") << "\"" << kEventNames[event]
+         << "\":" << GetEventCount(static_cast<MonitorEvent>(event));
+  file << "}}";
+  file << separator()
+       << "{\"name\":\"MotionPhaseTransition\",\"ph\":\"C\",\"pid\":0,"
+       << "\"ts\":" << last_ns / 1e3 << ",\"args\":{";
+  bool is_first_transition = true;
+  for (size_t from = 0; from < kNumPhases; from++) {
+    for (size_t to = 0; to < kNumPhases; to++) {
+      uint64_t count = GetTransitionCount(static_cast<MotionPhase>(from),
+                                          static_cast<MotionPhase>(to));
+      if (count == 0)
+        continue;
+      file << (is_first_transition ? "" : ",") << "\"" << kPhaseNames[from]
+           << "->" << kPhaseNames[to] << "\":" << count;
+      is_first_transition = false;
+    }
+  }
+  file << "}}\n]}\n";
+  return static_cast<bool>(file);
+}
+
+// Layout, all fields little-endian:
+//   char[4] "MRLT", uint32 version, uint32 num_stages, uint32 num_events,
+//   uint32 num_phases, uint32 num_threads
+//   per thread: uint32 thread_index, uint64 num_records,
+//               num_records x {uint64 begin_ns, uint32 duration_ns,
+//                              uint32 stage}
+//   per stage: uint64 count, uint64 total_ns, uint64 max_ns
+//   per event: uint64 count
+//   per (from, to) phase pair: uint64 count
+bool Tracer::WriteBinaryTrace(const std::string &path) {
+  std::ofstream file(path, std::ios::binary);
+  if (!file)
+    return false;
+  auto write = [&](auto value) {
+    char bytes[sizeof(value)];
+    for (size_t n = 0; n < sizeof(value); n++)
+      bytes[n] = static_cast<char>(static_cast<uint64_t>(value) >> (8 * n));
+    file.write(bytes, sizeof(value));
+  };
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  file.write("MRLT", 4);
+  write(uint32_t{1});
+  write(static_cast<uint32_t>(kNumStages));
+  write(static_cast<uint32_t>(kNumEvents));
+  write(static_cast<uint32_t>(kNumPhases));
+  write(static_cast<uint32_t>(registry.size()));
+  for (const auto &buffer : registry) {
+    uint64_t num_records = std::min<uint64_t>(
+        buffer->num_records.load(std::memory_order_acquire), kRecordCapacity);
+    write(buffer->thread_index);
+    write(num_records);
+    ForEachRecord(*buffer, [&](const TraceRecord &record) {
+      write(record.begin_ns);
+      write(record.duration_ns);
+      write(record.stage);
+    });
+  }
+  for (size_t stage = 0; stage < kNumStages; stage++) {
+    TraceStageStatistics statistics;
+    for (const auto &buffer : registry) {
+      const auto &counters = buffer->stages[stage];
+      statistics.count += counters.count.load(std::memory_order_relaxed);
+      statistics.total_ns +=
+          counters.total_ns.load(std::memory_order_relaxed);
+      statistics.max_ns = std::max(
+          statistics.max_ns, counters.max_ns.load(std::memory_order_relaxed));
+    }
+    write(statistics.count);
+    write(statistics.total_ns);
+    write(statistics.max_ns);
+  }
+  for (size_t event = 0; event < kNumEvents; event++) {
+    uint64_t count = 0;
+    for (const auto &buffer : registry)
+      count += buffer->events[event].load(std::memory_order_relaxed);
+    write(count);
+  }
+  for (size_t pair = 0; pair < kNumPhases * kNumPhases; pair++) {
+    uint64_t count = 0;
+    for (const auto &buffer : registry)
+      count += buffer->transitions[pair].load(std::memory_order_relaxed);
+    write(count);
+  }
+  return static_cast<bool>(file);
+}
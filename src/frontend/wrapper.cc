@@ -17,187 +17,302 @@
  *******************************************************************************/
 
 #include "my_robotics_library/frontend/wrapper.h"
+#include "my_robotics_library/frontend/tracing.h"
 
 using namespace my_robotics_library;
 
-Wrapper::Wrapper() { state_history_.push_back({MotionPhase::kIdle}); }
+namespace {
+class ClockLatch {
+public:
+  explicit ClockLatch(LatchedClock &clock) : clock_(clock) { clock_.Latch(); }
+  ~ClockLatch() { clock_.Unlatch(); }
+
+private:
+  LatchedClock &clock_;
+};
+} // namespace
+
+Wrapper::Wrapper(std::shared_ptr<const Clock> clock)
+    : Wrapper(Parameter(), std::move(clock)) {}
+
+Wrapper::Wrapper(const Parameter &parameter,
+                 std::shared_ptr<const Clock> clock)
+    : clock_(std::move(clock)),
+      callback_clock_(std::make_shared<LatchedClock>(clock_)),
+      parameter_(parameter), height_planner_(callback_clock_),
+      chasing_planner_(callback_clock_),
+      point_cloud_ingestor_(obstacle_manager_, parameter_.point_cloud) {
+  lookahead_trajectory_.Resize(parameter_.safety_check_num_samples);
+  if (parameter_.use_sampling_chasing_planner)
+    chasing_planner_.EnableSampling(parameter_.chasing_sampling,
+                                    parameter_.safety_distance,
+                                    &obstacle_manager_,
+                                    &GetDefaultThreadPool());
+  if (parameter_.use_async_chasing_planner)
+    async_chasing_planner_.reset(new backend::AsyncChasingPlanner(
+        chasing_planner_, parameter_.async_replan_target_tolerance,
+        parameter_.use_sampling_chasing_planner ? &obstacle_mutex_
+                                                : nullptr));
+  PushState({MotionPhase::kIdle});
+}
+
+double Wrapper::GetCurrentTime() const { return callback_clock_->Now(); }
+
+void Wrapper::PushState(const State &state) {
+  if (!state_history_.Empty())
+    MRL_TRACE_TRANSITION(state_history_.Back().motion_phase,
+                         state.motion_phase);
+  double current_time = GetCurrentTime();
+  if (flight_recorder_ && !state_history_.Empty())
+    flight_recorder_->RecordTransition(current_time,
+                                       state_history_.Back().motion_phase,
+                                       state.motion_phase);
+  state_history_.Push(state, current_time);
+}
+
+void Wrapper::ReadSensorSnapshot() {
+  MRL_TRACE_SCOPE(TraceStage::kReadSensorSnapshot);
+  sensor_information_ = sensor_buffer_.Load();
+  if (flight_recorder_)
+    flight_recorder_->RecordSensor(GetCurrentTime(), sensor_information_);
+  if (sensor_information_.target_position.has_value())
+    target_predictor_.AddDetection(sensor_information_.target_position.value());
+}
+
+void Wrapper::SetVelocity(const my_robotics_library::TimedVelocity &velocity) {
+  sensor_buffer_.Update(
+      [&](SensorInformation &sensor) { sensor.velocity = velocity; });
+}
 
 void Wrapper::SetPosition(const my_robotics_library::TimedPosition &position) {
-  sensor_information_.position = position;
+  sensor_buffer_.Update(
+      [&](SensorInformation &sensor) { sensor.position = position; });
   height_planner_.SetRobotPosition(position);
+  if (flight_recorder_)
+    flight_recorder_->RecordPosition(clock_->Now(), position);
 }
 
 void Wrapper::SetTargetPosition(
     const std::optional<TimedPosition> &target_position) {
-  sensor_information_.target_position = target_position;
+  sensor_buffer_.Update([&](SensorInformation &sensor) {
+    sensor.target_position = target_position;
+  });
 }
 
 void Wrapper::SetBatteryLevel(int level) {
-  sensor_information_.battery_level = level;
+  sensor_buffer_.Update(
+      [&](SensorInformation &sensor) { sensor.battery_level = level; });
 }
 
-void Wrapper::UpdateMonitor() {
-  auto current_motion_phase = state_history_.back().motion_phase;
-
-  if ((current_motion_phase != MotionPhase::kChasing &&
-       current_motion_phase != MotionPhase::kExploration) ||
-      !sensor_information_.target_position.has_value())
-    monitor_.is_planning_visible = false;
-  else
-    monitor_.is_planning_visible = true;
-
-  if (state_history_.back().motion_phase == MotionPhase::kHolding)
-    monitor_.is_safe_for_short_horizon = true;
-  else if (std::abs(sensor_information_.position.x) > 1)
-    monitor_.is_safe_for_short_horizon = false;
+void Wrapper::IngestPointCloud(const PointCloudView &cloud, double t) {
+  point_cloud_ingestor_.Downsample(cloud);
+  bool is_merged = false;
+  while (!is_merged) {
+    std::unique_lock<std::shared_mutex> lock(obstacle_mutex_);
+    is_merged = point_cloud_ingestor_.MergeSlice(t);
+  }
+}
 
-  monitor_.is_battery_enough = sensor_information_.battery_level > 0;
+// Checks the plan being served, which while an async chasing plan is
+// pending is still the previous one
+bool Wrapper::IsLookaheadSafe() {
+  if (is_degraded_ || !motion_planning_result_.HasValue())
+    return true;
+  double t0 = GetCurrentTime();
+  motion_planning_result_.SampleTrajectory(
+      t0, parameter_.safety_check_horizon / lookahead_trajectory_.Size(),
+      lookahead_trajectory_);
+  return !obstacle_manager_
+              .CheckTrajectory(lookahead_trajectory_,
+                               parameter_.safety_distance)
+              .is_violated;
 }
 
-MonitorEvent Wrapper::ReadMonitorEvent() const {
-  if (!monitor_.is_battery_enough &&
-      state_history_.back().motion_phase != MotionPhase::kLanding)
-    return MonitorEvent::kLand;
+void Wrapper::UpdateMonitor() {
+  MRL_TRACE_SCOPE(TraceStage::kUpdateMonitor);
+  monitor_.is_planning_visible =
+      IsPlanningVisible(state_history_.Back().motion_phase,
+                        sensor_information_.target_position.has_value());
 
-  if (!monitor_.is_safe_for_short_horizon)
-    return MonitorEvent::kHoldStop;
+  monitor_.is_safe_for_short_horizon =
+      obstacle_manager_.GetDistanceToObstacle(sensor_information_.position) >
+          parameter_.safety_distance &&
+      IsLookaheadSafe();
 
-  switch (state_history_.back().motion_phase) {
-  case MotionPhase::kChasing: {
-    if (!monitor_.is_planning_visible)
-      return kExplore;
+  monitor_.is_battery_enough =
+      IsBatteryEnough(sensor_information_.battery_level);
+}
 
-    using namespace std::chrono;
-    auto elapse_since_planning =
-        duration<double>(system_clock::now().time_since_epoch()).count() -
-        motion_planning_result_->GetRequestTime();
-    if (elapse_since_planning > 0.2)
-      return MonitorEvent::kChaseReplan;
-  }
-  case MotionPhase::kExploration: {
-    if (monitor_.is_planning_visible)
-      return kChaseReplan;
-  }
-  case MotionPhase::kHolding: {
-    auto previous_state = state_history_[state_history_.size() - 2];
-    if (monitor_.is_safe_for_short_horizon) {
-      switch (previous_state.motion_phase) {
-      case MotionPhase::kExploration:
-        return MonitorEvent::kExplore;
-      case MotionPhase::kChasing:
-        return MonitorEvent::kChaseReplan;
-      case MotionPhase::kHovering:
-        return MonitorEvent::kHover;
-      case MotionPhase::kLanding:
-        return MonitorEvent::kLand;
-      }
-    }
-  }
-  }
-  return MonitorEvent::kNone;
+MonitorEvent Wrapper::ReadMonitorEvent(uint32_t posted_events) const {
+  MRL_TRACE_SCOPE(TraceStage::kReadMonitorEvent);
+  const auto &state = state_history_.Back();
+  StateMachineInput input;
+  input.monitor = monitor_;
+  input.is_chasing_replan_due = GetCurrentTime() - chasing_request_time_ >
+                                parameter_.chasing_replan_period;
+  input.is_target_detected = sensor_information_.target_position.has_value();
+  input.resume_phase = state.resume_phase;
+  return SelectMonitorEvent(state.motion_phase, input, posted_events);
 }
 
 void Wrapper::OnTimerCallback() {
-  UpdateMonitor();
-  auto event_type = ReadMonitorEvent();
-  if (event_type != MonitorEvent::kNone)
-    state_history_.push_back(ProcessEvent(state_history_.back(), event_type));
+  MRL_TRACE_SCOPE(TraceStage::kTimerTick);
+  ClockLatch latch(*callback_clock_);
+  if (flight_recorder_)
+    flight_recorder_->RecordTimerTick(GetCurrentTime());
+  ReadSensorSnapshot();
+  if (async_chasing_planner_)
+    async_chasing_planner_->Poll(motion_planning_result_);
+  ProcessEvents();
+}
+
+void Wrapper::ProcessEvents() {
+  std::shared_lock<std::shared_mutex> lock(obstacle_mutex_);
+  uint32_t posted_events = event_queue_.TakeAll();
+  bool is_settled = false;
+  for (int n = 0; n < parameter_.max_events_per_tick; n++) {
+    // a transition may change what the monitor sees, so look again
+    UpdateMonitor();
+    auto event_type = ReadMonitorEvent(posted_events);
+    MRL_TRACE_EVENT(event_type);
+    if (flight_recorder_)
+      flight_recorder_->RecordMonitorEvent(GetCurrentTime(), event_type);
+    if (event_type == MonitorEvent::kNone) {
+      is_settled = true;
+      break;
+    }
+    posted_events &= ~(1u << event_type);
+    PushState(ProcessEvent(state_history_.Back(), event_type));
+  }
+  // out of budget: commands still pending wait for the next tick, while
+  // commands their guards rejected are dropped
+  posted_events &= state_machine::kCommandEvents;
+  if (posted_events && !is_settled)
+    event_queue_.Restore(posted_events);
+  if (control_streamer_)
+    control_streamer_->Publish(state_history_.Back().motion_phase,
+                               motion_planning_result_);
 }
 
 void Wrapper::OnHoveringCommandCallback() {
-  state_history_.push_back(HandleHovering(state_history_.back()));
+  MRL_TRACE_SCOPE(TraceStage::kHoveringCommand);
+  ClockLatch latch(*callback_clock_);
+  if (flight_recorder_)
+    flight_recorder_->RecordCommand(FlightRecordType::kHoveringCommand,
+                                    GetCurrentTime());
+  ReadSensorSnapshot();
+  event_queue_.Post(MonitorEvent::kHoverCommand);
+  ProcessEvents();
 }
 
 void Wrapper::OnChasingCommandCallback() {
-  state_history_.push_back(HandleChasingPlan(state_history_.back()));
+  MRL_TRACE_SCOPE(TraceStage::kChasingCommand);
+  ClockLatch latch(*callback_clock_);
+  if (flight_recorder_)
+    flight_recorder_->RecordCommand(FlightRecordType::kChasingCommand,
+                                    GetCurrentTime());
+  ReadSensorSnapshot();
+  event_queue_.Post(MonitorEvent::kChaseCommand);
+  ProcessEvents();
+}
+
+void Wrapper::PostHoveringCommand() {
+  if (flight_recorder_)
+    flight_recorder_->RecordCommand(FlightRecordType::kPostedHoveringCommand,
+                                    clock_->Now());
+  event_queue_.Post(MonitorEvent::kHoverCommand);
+}
+
+void Wrapper::PostChasingCommand() {
+  if (flight_recorder_)
+    flight_recorder_->RecordCommand(FlightRecordType::kPostedChasingCommand,
+                                    clock_->Now());
+  event_queue_.Post(MonitorEvent::kChaseCommand);
 }
 
 Control Wrapper::GetControl() const {
-  double current_time = 0.0;
-  auto current_motion_phase = state_history_.back().motion_phase;
-
-  if (current_motion_phase == MotionPhase::kIdle)
-    return Control();
-  else if (current_motion_phase == MotionPhase::kHolding)
-    return Control{MotionPhase::kHolding, 0, 0};
-  else if (current_motion_phase == MotionPhase::kExploration)
-    return Control{MotionPhase::kExploration, 0, 0};
-  else
-    return motion_planning_result_->GenerateControl(current_time);
-}
-
-State Wrapper::ProcessEvent(const State &state, const MonitorEvent &event) {
-  State new_state = state;
-  switch (event) {
-  case kHover:
-    new_state = HandleHovering(state);
-    break;
-    
-  case kLand:
-    new_state = HandleLanding(state);
-    break;
-
-  case kHoldStop:
-    new_state = HandleHoldStop(state);
-    break;
-
-  case kExplore:
-    new_state = HandleExploration(state);
-    break;
-
-  case kChaseReplan:
-    new_state = HandleChasingPlan(state);
-    break;
-  }
-  return new_state;
-};
+  MRL_TRACE_SCOPE(TraceStage::kGetControl);
+  double current_time = GetCurrentTime();
+  auto control = GenerateControl(current_time);
+  if (flight_recorder_)
+    flight_recorder_->RecordControl(current_time, control);
+  return control;
+}
 
-State Wrapper::HandleLanding(const my_robotics_library::State &state) {
-  auto new_state = state;
-  new_state.motion_phase = MotionPhase::kLanding;
+Control Wrapper::GenerateControl(double current_time) const {
+  return my_robotics_library::GenerateControl(
+      state_history_.Back().motion_phase, motion_planning_result_,
+      current_time);
+}
 
-  backend::HeightPlannerInput input;
-  input.target_height = 0.0;
-  auto height_plan = height_planner_.ComputeHeightMotion(input);
-  motion_planning_result_.reset(
-      new backend::HeightMotionPlanningResult(height_plan));
-  return new_state;
+void Wrapper::SetControlStreamer(ControlStreamer *control_streamer) {
+  control_streamer_ = control_streamer;
+  if (control_streamer_)
+    control_streamer_->Publish(state_history_.Back().motion_phase,
+                               motion_planning_result_);
 }
 
-State Wrapper::HandleHoldStop(const my_robotics_library::State &state) {
+State Wrapper::ProcessEvent(const State &state, MonitorEvent event) {
+  const auto &transition = GetTransition(state.motion_phase, event);
+  if (!transition.is_guarded)
+    return state;
+  if (!(this->*kActionHandlers[static_cast<size_t>(transition.action)])())
+    return state;
+
+  // a chasing plan still in flight no longer applies
+  if (async_chasing_planner_ && transition.next_phase != MotionPhase::kChasing)
+    async_chasing_planner_->Cancel();
+
   auto new_state = state;
-  new_state.motion_phase = MotionPhase::kHolding;
+  new_state.motion_phase = transition.next_phase;
+  if (transition.next_phase == MotionPhase::kHolding)
+    new_state.resume_phase = state.motion_phase;
   return new_state;
 }
 
-State Wrapper::HandleExploration(const my_robotics_library::State &state) {
-  auto new_state = state;
-  new_state.motion_phase = MotionPhase::kExploration;
-  return new_state;
+bool Wrapper::HandleLanding() {
+  MRL_TRACE_SCOPE(TraceStage::kHandleLanding);
+  backend::HeightPlannerInput input;
+  input.target_height = 0.0;
+  {
+    MRL_TRACE_SCOPE(TraceStage::kPlanning);
+    height_planner_.ComputeHeightMotion(input, motion_planning_result_);
+  }
+  return true;
 }
 
-State Wrapper::HandleChasingPlan(const my_robotics_library::State &state) {
+bool Wrapper::HandleChasingPlan() {
+  MRL_TRACE_SCOPE(TraceStage::kHandleChasingPlan);
   if (!sensor_information_.target_position.has_value())
-    return state;
+    return false;
 
-  auto new_state = state;
-  new_state.motion_phase = MotionPhase::kChasing;
   backend::ChasingPlannerInput input;
   input.target_position = sensor_information_.target_position.value();
-  auto chasing_plan = chasing_planner_.ComputeChasingMotion(input);
-  motion_planning_result_.reset(
-      new backend::ChasingMotionPlanningResult(chasing_plan));
-  return new_state;
+  double current_time = GetCurrentTime();
+  if (parameter_.use_target_prediction &&
+      target_predictor_.HasEstimate(current_time)) {
+    input.target_position = target_predictor_.PredictPosition(current_time);
+    input.target_velocity = target_predictor_.GetVelocity();
+  }
+  input.robot_position = sensor_information_.position;
+  input.robot_velocity = sensor_information_.velocity;
+  input.horizon = parameter_.chasing_horizon;
+  chasing_request_time_ = current_time;
+  MRL_TRACE_SCOPE(TraceStage::kPlanning);
+  if (async_chasing_planner_)
+    async_chasing_planner_->Submit(input);
+  else
+    chasing_planner_.ComputeChasingMotion(input, motion_planning_result_);
+  return true;
 }
 
-State Wrapper::HandleHovering(const my_robotics_library::State &state) {
-  auto new_state = state;
-  new_state.motion_phase = MotionPhase::kHovering;
-
+bool Wrapper::HandleHovering() {
+  MRL_TRACE_SCOPE(TraceStage::kHandleHovering);
   backend::HeightPlannerInput input;
   input.target_height = parameter_.hovering_height;
-  auto height_plan = height_planner_.ComputeHeightMotion(input);
-  motion_planning_result_.reset(
-      new backend::HeightMotionPlanningResult(height_plan));
-  return new_state;
+  {
+    MRL_TRACE_SCOPE(TraceStage::kPlanning);
+    height_planner_.ComputeHeightMotion(input, motion_planning_result_);
+  }
+  return true;
 }
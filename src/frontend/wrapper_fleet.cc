@@ -0,0 +1,254 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/wrapper_fleet.h"
+#include "my_robotics_library/frontend/control_streamer.h"
+
+#include <algorithm>
+
+using namespace my_robotics_library;
+
+WrapperFleet::WrapperFleet(size_t num_vehicles, const Parameter &parameter,
+                           std::shared_ptr<const Clock> clock,
+                           ThreadPool &thread_pool)
+    : num_vehicles_(num_vehicles), parameter_(parameter),
+      clock_(std::move(clock)), thread_pool_(thread_pool) {
+  for (auto array : {&position_t_, &position_x_, &position_y_, &position_z_,
+                     &velocity_t_, &velocity_x_, &velocity_y_, &velocity_z_,
+                     &target_t_, &target_x_, &target_y_, &target_z_,
+                     &obstacle_distance_, &chasing_request_time_})
+    array->assign(num_vehicles, 0.0);
+  for (auto array : {&is_target_detected_, &is_planning_visible_,
+                     &is_safe_for_short_horizon_, &is_battery_enough_})
+    array->assign(num_vehicles, 0);
+  battery_level_.assign(num_vehicles, 1);
+  motion_phase_.assign(num_vehicles, MotionPhase::kIdle);
+  resume_phase_.assign(num_vehicles, MotionPhase::kIdle);
+  posted_events_.assign(num_vehicles, 0);
+  // the initial idle state
+  num_transitions_.assign(num_vehicles, 1);
+
+  height_planners_.reserve(num_vehicles);
+  for (size_t n = 0; n < num_vehicles; n++)
+    height_planners_.emplace_back(new backend::HeightPlanner(clock_));
+  target_predictors_.resize(num_vehicles);
+  motion_planning_results_.resize(num_vehicles);
+
+  size_t num_blocks = (num_vehicles + kBlockSize - 1) / kBlockSize;
+  block_scratch_.reserve(num_blocks);
+  for (size_t block = 0; block < num_blocks; block++) {
+    block_scratch_.emplace_back(clock_);
+    block_scratch_.back().lookahead_trajectory.Resize(
+        parameter_.safety_check_num_samples);
+  }
+}
+
+void WrapperFleet::SetVelocity(size_t vehicle, const TimedVelocity &velocity) {
+  velocity_t_[vehicle] = velocity.t;
+  velocity_x_[vehicle] = velocity.x;
+  velocity_y_[vehicle] = velocity.y;
+  velocity_z_[vehicle] = velocity.z;
+}
+
+void WrapperFleet::SetPosition(size_t vehicle, const TimedPosition &position) {
+  position_t_[vehicle] = position.t;
+  position_x_[vehicle] = position.x;
+  position_y_[vehicle] = position.y;
+  position_z_[vehicle] = position.z;
+  height_planners_[vehicle]->SetRobotPosition(position);
+}
+
+void WrapperFleet::SetTargetPosition(
+    size_t vehicle, const std::optional<TimedPosition> &target_position) {
+  is_target_detected_[vehicle] = target_position.has_value();
+  auto target = target_position.value_or(TimedPosition());
+  target_t_[vehicle] = target.t;
+  target_x_[vehicle] = target.x;
+  target_y_[vehicle] = target.y;
+  target_z_[vehicle] = target.z;
+}
+
+void WrapperFleet::SetBatteryLevel(size_t vehicle, int level) {
+  battery_level_[vehicle] = level;
+}
+
+void WrapperFleet::PostHoveringCommand(size_t vehicle) {
+  posted_events_[vehicle] |= 1u << MonitorEvent::kHoverCommand;
+}
+
+void WrapperFleet::PostChasingCommand(size_t vehicle) {
+  posted_events_[vehicle] |= 1u << MonitorEvent::kChaseCommand;
+}
+
+void WrapperFleet::Tick() {
+  double current_time = clock_->Now();
+  thread_pool_.ParallelFor(0, block_scratch_.size(), 1, [&](size_t block) {
+    TickBlock(block, current_time);
+  });
+}
+
+void WrapperFleet::TickBlock(size_t block, double current_time) {
+  const size_t begin = block * kBlockSize;
+  const size_t end = std::min(begin + kBlockSize, num_vehicles_);
+  auto &scratch = block_scratch_[block];
+
+  // the sensor snapshot feeds the target predictors
+  for (size_t n = begin; n < end; n++)
+    if (is_target_detected_[n])
+      target_predictors_[n].AddDetection(
+          {target_t_[n], target_x_[n], target_y_[n], target_z_[n]});
+
+  // flat monitor passes over the block
+  obstacle_manager_.GetDistancesToObstacle(
+      &position_x_[begin], &position_y_[begin], &position_z_[begin],
+      end - begin, &obstacle_distance_[begin]);
+  for (size_t n = begin; n < end; n++) {
+    is_battery_enough_[n] = IsBatteryEnough(battery_level_[n]);
+    is_planning_visible_[n] =
+        IsPlanningVisible(static_cast<MotionPhase>(motion_phase_[n]),
+                          is_target_detected_[n]);
+    is_safe_for_short_horizon_[n] =
+        obstacle_distance_[n] > parameter_.safety_distance;
+  }
+  for (size_t n = begin; n < end; n++)
+    if (is_safe_for_short_horizon_[n])
+      is_safe_for_short_horizon_[n] =
+          IsLookaheadSafe(n, current_time, scratch.lookahead_trajectory);
+
+  for (size_t n = begin; n < end; n++)
+    ProcessEvents(n, current_time, scratch);
+}
+
+bool WrapperFleet::IsLookaheadSafe(
+    size_t vehicle, double current_time,
+    TrajectorySamples &lookahead_trajectory) const {
+  const auto &result = motion_planning_results_[vehicle];
+  if (!result.HasValue())
+    return true;
+  result.SampleTrajectory(current_time,
+                          parameter_.safety_check_horizon /
+                              lookahead_trajectory.Size(),
+                          lookahead_trajectory);
+  return !obstacle_manager_
+              .CheckTrajectory(lookahead_trajectory,
+                               parameter_.safety_distance)
+              .is_violated;
+}
+
+void WrapperFleet::UpdateMonitor(size_t vehicle, double current_time,
+                                 TrajectorySamples &lookahead_trajectory) {
+  // the position did not change within the tick, so the distance holds
+  is_planning_visible_[vehicle] =
+      IsPlanningVisible(static_cast<MotionPhase>(motion_phase_[vehicle]),
+                        is_target_detected_[vehicle]);
+  is_safe_for_short_horizon_[vehicle] =
+      obstacle_distance_[vehicle] > parameter_.safety_distance &&
+      IsLookaheadSafe(vehicle, current_time, lookahead_trajectory);
+}
+
+void WrapperFleet::ProcessEvents(size_t vehicle, double current_time,
+                                 BlockScratch &scratch) {
+  uint32_t posted_events = posted_events_[vehicle];
+  bool is_settled = false;
+  for (int n = 0; n < parameter_.max_events_per_tick; n++) {
+    if (n > 0)
+      UpdateMonitor(vehicle, current_time, scratch.lookahead_trajectory);
+
+    auto motion_phase = static_cast<MotionPhase>(motion_phase_[vehicle]);
+    StateMachineInput input;
+    input.monitor.is_planning_visible = is_planning_visible_[vehicle];
+    input.monitor.is_safe_for_short_horizon =
+        is_safe_for_short_horizon_[vehicle];
+    input.monitor.is_battery_enough = is_battery_enough_[vehicle];
+    input.is_chasing_replan_due =
+        current_time - chasing_request_time_[vehicle] >
+        parameter_.chasing_replan_period;
+    input.is_target_detected = is_target_detected_[vehicle];
+    input.resume_phase = static_cast<MotionPhase>(resume_phase_[vehicle]);
+    auto event = SelectMonitorEvent(motion_phase, input, posted_events);
+    if (event == MonitorEvent::kNone) {
+      is_settled = true;
+      break;
+    }
+    posted_events &= ~(1u << event);
+
+    // same as Wrapper::ProcessEvent followed by PushState
+    const auto &transition = GetTransition(motion_phase, event);
+    num_transitions_[vehicle]++;
+    if (!transition.is_guarded || !RunAction(transition.action, vehicle,
+                                        current_time, scratch.chasing_planner))
+      continue;
+    if (transition.next_phase == MotionPhase::kHolding)
+      resume_phase_[vehicle] = motion_phase;
+    motion_phase_[vehicle] = transition.next_phase;
+  }
+  // as in Wrapper::ProcessEvents, rejected commands are dropped
+  posted_events_[vehicle] =
+      is_settled ? 0 : posted_events & state_machine::kCommandEvents;
+}
+
+bool WrapperFleet::RunAction(TransitionAction action, size_t vehicle,
+                             double current_time,
+                             backend::ChasingPlanner &chasing_planner) {
+  switch (action) {
+  case TransitionAction::kNone:
+    return true;
+  case TransitionAction::kPlanHovering:
+    PlanHeight(vehicle, parameter_.hovering_height);
+    return true;
+  case TransitionAction::kPlanLanding:
+    PlanHeight(vehicle, 0.0);
+    return true;
+  case TransitionAction::kPlanChasing:
+    break;
+  }
+
+  if (!is_target_detected_[vehicle])
+    return false;
+  backend::ChasingPlannerInput input;
+  input.target_position = {target_t_[vehicle], target_x_[vehicle],
+                           target_y_[vehicle], target_z_[vehicle]};
+  const auto &target_predictor = target_predictors_[vehicle];
+  if (parameter_.use_target_prediction &&
+      target_predictor.HasEstimate(current_time)) {
+    input.target_position = target_predictor.PredictPosition(current_time);
+    input.target_velocity = target_predictor.GetVelocity();
+  }
+  input.robot_position = {position_t_[vehicle], position_x_[vehicle],
+                          position_y_[vehicle], position_z_[vehicle]};
+  input.robot_velocity = {velocity_t_[vehicle], velocity_x_[vehicle],
+                          velocity_y_[vehicle], velocity_z_[vehicle]};
+  input.horizon = parameter_.chasing_horizon;
+  chasing_request_time_[vehicle] = current_time;
+  chasing_planner.ComputeChasingMotion(input,
+                                       motion_planning_results_[vehicle]);
+  return true;
+}
+
+void WrapperFleet::PlanHeight(size_t vehicle, double target_height) {
+  backend::HeightPlannerInput input;
+  input.target_height = target_height;
+  height_planners_[vehicle]->ComputeHeightMotion(
+      input, motion_planning_results_[vehicle]);
+}
+
+Control WrapperFleet::GetControl(size_t vehicle) const {
+  return GenerateControl(GetMotionPhase(vehicle),
+                         motion_planning_results_[vehicle], clock_->Now());
+}
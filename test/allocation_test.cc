@@ -0,0 +1,296 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/frontend/wrapper.h"
+#include <gtest/gtest.h>
+
+#include <execinfo.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace my_robotics_library;
+
+// Replaces the global allocation functions to count the allocations made,
+// on any thread, while tracking is on. Set MRL_ALLOCATION_BACKTRACE to
+// print the stack of every tracked allocation.
+
+namespace {
+std::atomic<bool> is_tracking{false};
+std::atomic<size_t> num_allocations{0};
+bool is_printing_backtraces = false;
+
+void CountAllocation() {
+  if (!is_tracking.load(std::memory_order_relaxed))
+    return;
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (is_printing_backtraces) {
+    void *frames[32];
+    int num_frames = backtrace(frames, 32);
+    backtrace_symbols_fd(frames, num_frames, STDERR_FILENO);
+    write(STDERR_FILENO, "\n", 1);
+  }
+}
+
+void *Allocate(size_t size, size_t alignment) {
+  CountAllocation();
+  if (size == 0)
+    size = 1;
+  void *pointer = alignment <= alignof(std::max_align_t)
+                      ? std::malloc(size)
+                      : std::aligned_alloc(
+                            alignment, (size + alignment - 1) / alignment *
+                                           alignment);
+  if (!pointer)
+    throw std::bad_alloc();
+  return pointer;
+}
+} // namespace
+
+void *operator new(size_t size) { return Allocate(size, 0); }
+void *operator new[](size_t size) { return Allocate(size, 0); }
+void *operator new(size_t size, std::align_val_t alignment) {
+  return Allocate(size, static_cast<size_t>(alignment));
+}
+void *operator new[](size_t size, std::align_val_t alignment) {
+  return Allocate(size, static_cast<size_t>(alignment));
+}
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+void operator delete[](void *pointer, size_t, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+namespace {
+class AllocationTracker {
+public:
+  AllocationTracker() {
+    is_printing_backtraces = std::getenv("MRL_ALLOCATION_BACKTRACE");
+    if (is_printing_backtraces) {
+      // the first backtrace loads the unwinder, which allocates
+      void *frame;
+      backtrace(&frame, 1);
+    }
+    num_allocations.store(0);
+    is_tracking.store(true);
+  }
+  ~AllocationTracker() { is_tracking.store(false); }
+
+  size_t GetNumAllocations() const { return num_allocations.load(); }
+};
+
+const TimedPosition kObstacle{0.0, 0.0, 10.0, 1.0};
+
+// Flies a wrapper through every flight phase at 100 Hz the way a frontend
+// would: sensors are set and the control is read on every tick. Commands
+// go through both the callbacks and the posted path.
+class Mission {
+public:
+  Mission(Wrapper &wrapper, SimulatedClock &clock)
+      : wrapper_(wrapper), clock_(clock),
+        num_seen_(wrapper.GetStateHistory().GetNumPushed()) {}
+
+  void FlyLap() {
+    battery_level_ = 100;
+    position_ = {0.0, 0.0, 0.0, 0.0};
+    wrapper_.SetPosition(position_);
+    wrapper_.SetBatteryLevel(battery_level_);
+    wrapper_.OnHoveringCommandCallback();
+    Fly(50, 0.0, 0.0, 1.0);
+    // too close to the obstacle while hovering, then back off
+    Fly(10, 0.0, 9.5, 1.0);
+    Fly(10, 0.0, 0.0, 1.0);
+
+    is_target_detected_ = true;
+    wrapper_.PostChasingCommand();
+    Fly(100, 0.0, 0.0, 1.0);
+    is_target_detected_ = false;
+    Fly(20, 0.0, 0.0, 1.0);
+    is_target_detected_ = true;
+    Fly(20, 0.0, 0.0, 1.0);
+    // hold while chasing and resume the chase
+    Fly(10, 0.0, 9.5, 1.0);
+    Fly(30, 0.0, 0.0, 1.0);
+    // hold while chasing and resume exploring: the target is gone
+    Fly(10, 0.0, 9.5, 1.0);
+    is_target_detected_ = false;
+    Fly(10, 0.0, 0.0, 1.0);
+    is_target_detected_ = true;
+    wrapper_.OnChasingCommandCallback();
+    Fly(20, 0.0, 0.0, 1.0);
+
+    // a low battery lands from a hold
+    Fly(10, 0.0, 9.5, 1.0);
+    battery_level_ = 0;
+    Fly(40, 0.0, 9.5, 0.0);
+    is_target_detected_ = false;
+  }
+
+  bool HasTransition(MotionPhase from, MotionPhase to) const {
+    return transitions_[from][to];
+  }
+  // a tick using its whole event budget has not settled
+  uint64_t GetMaxTransitionsPerTick() const {
+    return max_transitions_per_tick_;
+  }
+  bool HasEntered(MotionPhase phase) const {
+    for (size_t from = 0; from < kNumMotionPhases; from++)
+      if (transitions_[from][phase])
+        return true;
+    return false;
+  }
+
+private:
+  Wrapper &wrapper_;
+  SimulatedClock &clock_;
+  TimedPosition position_;
+  int battery_level_{100};
+  bool is_target_detected_{false};
+  uint64_t num_seen_;
+  uint64_t max_transitions_per_tick_{0};
+  bool transitions_[kNumMotionPhases][kNumMotionPhases]{};
+
+  // Moves towards (x, y, z) over the ticks while the target circles ahead.
+  void Fly(int num_ticks, double x, double y, double z) {
+    for (int tick = 0; tick < num_ticks; tick++) {
+      clock_.Advance(0.01);
+      double t = clock_.Now();
+      double ratio = 1.0 / (num_ticks - tick);
+      TimedVelocity velocity{t, (x - position_.x) * ratio * 100.0,
+                             (y - position_.y) * ratio * 100.0,
+                             (z - position_.z) * ratio * 100.0};
+      position_ = {t, position_.x + (x - position_.x) * ratio,
+                   position_.y + (y - position_.y) * ratio,
+                   position_.z + (z - position_.z) * ratio};
+      wrapper_.SetVelocity(velocity);
+      wrapper_.SetPosition(position_);
+      wrapper_.SetBatteryLevel(battery_level_);
+      if (is_target_detected_)
+        wrapper_.SetTargetPosition(
+            TimedPosition{t, 2.0 + 0.5 * std::cos(t), 0.5 * std::sin(t), 1.0});
+      else
+        wrapper_.SetTargetPosition(std::nullopt);
+      wrapper_.OnTimerCallback();
+      wrapper_.GetControl();
+      RecordTransitions();
+    }
+  }
+
+  void RecordTransitions() {
+    const auto &history = wrapper_.GetStateHistory();
+    uint64_t num_new = history.GetNumPushed() - num_seen_;
+    max_transitions_per_tick_ = std::max(max_transitions_per_tick_, num_new);
+    for (size_t i = history.Size() - num_new; i < history.Size(); i++)
+      transitions_[history.At(i - 1).state.motion_phase]
+                  [history.At(i).state.motion_phase] = true;
+    num_seen_ = history.GetNumPushed();
+  }
+};
+
+void ExpectAllocationFreeLaps(const Parameter &parameter) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(parameter, clock);
+  wrapper.GetObstacleManager().InsertObstacle(kObstacle);
+  FlightRecorder flight_recorder;
+  ASSERT_TRUE(flight_recorder.OpenInMemory(1 << 16));
+  wrapper.SetFlightRecorder(&flight_recorder);
+  ControlStreamer control_streamer(ControlStreamerOptions(), clock);
+  wrapper.SetControlStreamer(&control_streamer);
+
+  // tracing builds set up a trace buffer on the first use of every thread
+  Mission warm_up(wrapper, *clock);
+  warm_up.FlyLap();
+
+  Mission mission(wrapper, *clock);
+  size_t num_allocations;
+  {
+    AllocationTracker tracker;
+    for (int lap = 0; lap < 10; lap++)
+      mission.FlyLap();
+    num_allocations = tracker.GetNumAllocations();
+  }
+  EXPECT_EQ(num_allocations, 0u);
+  EXPECT_LT(mission.GetMaxTransitionsPerTick(),
+            static_cast<uint64_t>(parameter.max_events_per_tick));
+
+  for (auto phase : {MotionPhase::kLanding, MotionPhase::kHolding,
+                     MotionPhase::kExploration, MotionPhase::kChasing,
+                     MotionPhase::kHovering})
+    EXPECT_TRUE(mission.HasEntered(phase)) << phase;
+  EXPECT_TRUE(
+      mission.HasTransition(MotionPhase::kLanding, MotionPhase::kHovering));
+  EXPECT_TRUE(
+      mission.HasTransition(MotionPhase::kHovering, MotionPhase::kHolding));
+  EXPECT_TRUE(
+      mission.HasTransition(MotionPhase::kHolding, MotionPhase::kHovering));
+  EXPECT_TRUE(
+      mission.HasTransition(MotionPhase::kHovering, MotionPhase::kChasing));
+  EXPECT_TRUE(
+      mission.HasTransition(MotionPhase::kChasing, MotionPhase::kChasing));
+  EXPECT_TRUE(
+      mission.HasTransition(MotionPhase::kChasing, MotionPhase::kExploration));
+  EXPECT_TRUE(
+      mission.HasTransition(MotionPhase::kExploration, MotionPhase::kChasing));
+  EXPECT_TRUE(
+      mission.HasTransition(MotionPhase::kChasing, MotionPhase::kHolding));
+  EXPECT_TRUE(
+      mission.HasTransition(MotionPhase::kHolding, MotionPhase::kChasing));
+  EXPECT_TRUE(
+      mission.HasTransition(MotionPhase::kHolding, MotionPhase::kExploration));
+  EXPECT_TRUE(
+      mission.HasTransition(MotionPhase::kHolding, MotionPhase::kLanding));
+}
+} // namespace
+
+TEST(AllocationTracker, CountsAllocations) {
+  AllocationTracker tracker;
+  std::vector<int> values(16);
+  EXPECT_EQ(tracker.GetNumAllocations(), 1u);
+}
+
+TEST(SteadyState, TicksWithoutAllocating) {
+  ExpectAllocationFreeLaps(Parameter());
+}
+
+TEST(SteadyState, SamplingChasingTicksWithoutAllocating) {
+  Parameter parameter;
+  parameter.use_sampling_chasing_planner = true;
+  ExpectAllocationFreeLaps(parameter);
+}
+
+TEST(SteadyState, AsyncChasingTicksWithoutAllocating) {
+  Parameter parameter;
+  parameter.use_async_chasing_planner = true;
+  ExpectAllocationFreeLaps(parameter);
+}
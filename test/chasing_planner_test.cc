@@ -0,0 +1,70 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/backend/planners/chasing_planner.h"
+#include "my_robotics_library/backend/thread_pool.h"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace my_robotics_library;
+using namespace my_robotics_library::backend;
+
+TEST(ThreadPool, ParallelForVisitsEveryIndexOnce) {
+  ThreadPool thread_pool(4);
+  const size_t kNumOuter = 64, kNumInner = 100;
+  std::vector<std::atomic<int>> visits(kNumOuter * kNumInner);
+
+  thread_pool.ParallelFor(0, kNumOuter, 1, [&](size_t i) {
+    thread_pool.ParallelFor(0, kNumInner, 8, [&](size_t j) {
+      visits[i * kNumInner + j].fetch_add(1, std::memory_order_relaxed);
+    });
+  });
+  for (const auto &visit : visits)
+    EXPECT_EQ(visit.load(), 1);
+}
+
+TEST(ChasingPlanner, SamplingAvoidsObstacleOnDirectPath) {
+  ObstacleManager obstacle_manager;
+  // wall between the robot and the predicted target
+  for (int iy = -6; iy <= 6; iy++)
+    for (int iz = -6; iz <= 6; iz++)
+      obstacle_manager.InsertObstacle({0, 2.0, 0.25 * iy, 0.25 * iz});
+
+  ChasingPlannerInput input;
+  input.target_position = {0, 4.0, 0, 0};
+  input.robot_position = {0, 0, 0, 0};
+  input.horizon = 1.0;
+
+  ChasingPlanner chasing_planner(std::make_shared<SimulatedClock>(0.0));
+  auto direct_result = chasing_planner.ComputeChasingMotion(input);
+  TrajectorySamples samples;
+  samples.Resize(20);
+  direct_result.SampleTrajectory(0.0, 1.0 / 19, samples);
+  EXPECT_TRUE(obstacle_manager.CheckTrajectory(samples, 0.5).is_violated);
+
+  ThreadPool thread_pool(2);
+  ChasingSamplingParameter parameter;
+  parameter.min_view_distance = 2.0;
+  chasing_planner.EnableSampling(parameter, 0.5, &obstacle_manager,
+                                 &thread_pool);
+  auto sampled_result = chasing_planner.ComputeChasingMotion(input);
+  sampled_result.SampleTrajectory(0.0, 1.0 / 19, samples);
+  EXPECT_FALSE(obstacle_manager.CheckTrajectory(samples, 0.5).is_violated);
+}
@@ -0,0 +1,158 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/control_streamer.h"
+#include "my_robotics_library/frontend/wrapper.h"
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace my_robotics_library;
+
+TEST(TripleBuffer, ReaderSeesTheLatestConsistentValue) {
+  struct Pair {
+    uint64_t first{0};
+    uint64_t second{0};
+  };
+  TripleBuffer<Pair> buffer;
+  buffer.Write({1, 1});
+  buffer.Write({2, 2});
+  EXPECT_TRUE(buffer.HasUpdate());
+  EXPECT_EQ(buffer.Read().first, 2u);
+  EXPECT_FALSE(buffer.HasUpdate());
+  EXPECT_EQ(buffer.Read().first, 2u);
+
+  const uint64_t kNumWrites = 200000;
+  std::thread writer([&] {
+    for (uint64_t n = 3; n <= kNumWrites; n++)
+      buffer.Write({n, n});
+  });
+  uint64_t last = 0;
+  while (last < kNumWrites) {
+    const auto &value = buffer.Read();
+    ASSERT_EQ(value.first, value.second);
+    ASSERT_GE(value.first, last);
+    last = value.first;
+  }
+  writer.join();
+}
+
+TEST(SpscRing, DeliversInOrderAcrossThreads) {
+  SpscRing<uint64_t, 4> small;
+  uint64_t value = 0;
+  EXPECT_FALSE(small.TryPop(value));
+  for (uint64_t n = 0; n < 4; n++)
+    EXPECT_TRUE(small.TryPush(n));
+  EXPECT_FALSE(small.TryPush(4));
+  EXPECT_EQ(small.Size(), 4u);
+  EXPECT_TRUE(small.TryPop(value));
+  EXPECT_EQ(value, 0u);
+
+  const uint64_t kNumValues = 200000;
+  SpscRing<uint64_t, 64> ring;
+  std::thread producer([&] {
+    for (uint64_t n = 0; n < kNumValues;) {
+      if (ring.TryPush(n))
+        n++;
+      else
+        std::this_thread::yield();
+    }
+  });
+  for (uint64_t expected = 0; expected < kNumValues;) {
+    if (!ring.TryPop(value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(value, expected);
+    expected++;
+  }
+  producer.join();
+}
+
+TEST(ControlStreamer, SamplesThePlanAtTheCurrentTime) {
+  auto clock = std::make_shared<SimulatedClock>(1.0);
+  Wrapper wrapper(clock);
+  ControlStreamerOptions options;
+  options.num_consumers = 2;
+  ControlStreamer streamer(options, clock);
+  wrapper.SetControlStreamer(&streamer);
+  EXPECT_EQ(streamer.Step().phase, MotionPhase::kIdle);
+
+  wrapper.SetTargetPosition(TimedPosition{1.0, 3.0, 0, 0});
+  wrapper.OnHoveringCommandCallback();
+  wrapper.OnChasingCommandCallback();
+  ASSERT_EQ(wrapper.GetStateHistory().Back().motion_phase,
+            MotionPhase::kChasing);
+
+  // between planning ticks the samples follow the plan over time
+  for (int n = 0; n < 10; n++) {
+    clock->Advance(0.001);
+    auto expected = wrapper.GetControl();
+    auto sample = streamer.Step();
+    EXPECT_EQ(sample.phase, expected.phase);
+    EXPECT_DOUBLE_EQ(sample.t, clock->Now());
+    EXPECT_DOUBLE_EQ(sample.input, expected.input);
+  }
+
+  for (size_t consumer = 0; consumer < 2; consumer++) {
+    Control control;
+    size_t num_controls = 0;
+    while (streamer.GetRing(consumer).TryPop(control))
+      num_controls++;
+    EXPECT_EQ(num_controls, 11u);
+    EXPECT_EQ(control.phase, MotionPhase::kChasing);
+  }
+  EXPECT_EQ(streamer.GetNumSamples(), 11u);
+}
+
+TEST(ControlStreamer, DropsSamplesForFullRings) {
+  ControlStreamer streamer;
+  for (size_t n = 0; n < ControlStreamer::kRingCapacity + 10; n++)
+    streamer.Step();
+  EXPECT_EQ(streamer.GetNumDropped(), 10u);
+  EXPECT_EQ(streamer.GetRing(0).Size(), ControlStreamer::kRingCapacity);
+}
+
+TEST(ControlStreamer, StreamsToAnActuatorThread) {
+  Wrapper wrapper;
+  ControlStreamer streamer;
+  wrapper.SetControlStreamer(&streamer);
+  ASSERT_TRUE(streamer.Start());
+  wrapper.OnHoveringCommandCallback();
+
+  size_t num_hovering = 0;
+  double last_t = 0.0;
+  Control control;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (num_hovering < 20 && std::chrono::steady_clock::now() < deadline) {
+    if (!streamer.GetRing(0).TryPop(control)) {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      continue;
+    }
+    if (control.phase != MotionPhase::kHovering)
+      continue;
+    EXPECT_GT(control.t, last_t);
+    last_t = control.t;
+    num_hovering++;
+  }
+  streamer.Stop();
+  EXPECT_EQ(num_hovering, 20u);
+  EXPECT_FALSE(streamer.IsRunning());
+}
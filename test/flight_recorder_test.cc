@@ -0,0 +1,96 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/flight_recorder.h"
+#include "my_robotics_library/frontend/wrapper.h"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace my_robotics_library;
+
+TEST(FlightRecorder, RecordsWhatTheWrapperSawAndDecided) {
+  std::string path = testing::TempDir() + "flight_recorder_test.log";
+  auto clock = std::make_shared<SimulatedClock>(1.0);
+  {
+    FlightRecorder flight_recorder;
+    ASSERT_TRUE(flight_recorder.Open(path, 1024));
+    Wrapper wrapper(clock);
+    wrapper.SetFlightRecorder(&flight_recorder);
+
+    wrapper.OnHoveringCommandCallback();
+    wrapper.GetControl();
+    clock->Advance(0.1);
+    wrapper.SetBatteryLevel(0);
+    wrapper.SetTargetPosition(TimedPosition{1.1, 2, 3, 4});
+    wrapper.OnTimerCallback();
+    EXPECT_EQ(flight_recorder.GetNumDropped(), 0);
+  }
+
+  FlightLogReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  std::vector<FlightRecordType> types;
+  for (const auto &record : reader)
+    types.push_back(record.GetType());
+  // every drain of the event queue ends with a kNone event
+  std::vector<FlightRecordType> expected_types = {
+      FlightRecordType::kHoveringCommand, FlightRecordType::kSensor,
+      FlightRecordType::kMonitorEvent,    FlightRecordType::kTransition,
+      FlightRecordType::kMonitorEvent,    FlightRecordType::kControl,
+      FlightRecordType::kTimerTick,       FlightRecordType::kSensor,
+      FlightRecordType::kMonitorEvent,    FlightRecordType::kTransition,
+      FlightRecordType::kMonitorEvent};
+  EXPECT_EQ(types, expected_types);
+
+  EXPECT_EQ(reader[2].value, MonitorEvent::kHoverCommand);
+  EXPECT_EQ(reader[3].previous, MotionPhase::kIdle);
+  EXPECT_EQ(reader[3].value, MotionPhase::kHovering);
+  EXPECT_EQ(reader[4].value, MonitorEvent::kNone);
+  EXPECT_EQ(ToControl(reader[5]).phase, MotionPhase::kHovering);
+  EXPECT_DOUBLE_EQ(reader[6].t, 1.1);
+  auto sensor = ToSensorInformation(reader[7]);
+  EXPECT_EQ(sensor.battery_level, 0);
+  ASSERT_TRUE(sensor.target_position.has_value());
+  EXPECT_EQ(sensor.target_position->z, 4);
+  EXPECT_EQ(reader[8].value, MonitorEvent::kLand);
+  EXPECT_EQ(reader[9].value, MotionPhase::kLanding);
+  reader.Close();
+  std::remove(path.c_str());
+}
+
+TEST(FlightRecorder, CountsDroppedRecordsWhenFull) {
+  std::string path = testing::TempDir() + "flight_recorder_full.log";
+  FlightRecorder flight_recorder;
+  ASSERT_TRUE(flight_recorder.Open(path, 2));
+  for (int n = 0; n < 5; n++)
+    flight_recorder.RecordTimerTick(n);
+  EXPECT_EQ(flight_recorder.GetNumRecords(), 2);
+  EXPECT_EQ(flight_recorder.GetNumDropped(), 3);
+  flight_recorder.Close();
+
+  FlightLogReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  ASSERT_EQ(reader.Size(), 2);
+  EXPECT_EQ(reader[1].t, 1.0);
+  EXPECT_EQ(reader.GetNumDropped(), 3);
+  reader.Close();
+  std::remove(path.c_str());
+}
@@ -0,0 +1,118 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/loop_runner.h"
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include <sched.h>
+
+using namespace my_robotics_library;
+
+TEST(DurationHistogram, ReportsBucketQuantiles) {
+  DurationHistogram histogram;
+  EXPECT_EQ(histogram.GetQuantile(0.5), 0u);
+  for (int n = 0; n < 99; n++)
+    histogram.Add(1000); // bucket [512, 1024)
+  histogram.Add(50000);
+  EXPECT_EQ(histogram.GetNumSamples(), 100u);
+  EXPECT_EQ(histogram.GetMax(), 50000u);
+  EXPECT_EQ(histogram.GetBucketCount(10), 99u);
+  EXPECT_EQ(histogram.GetQuantile(0.5), 1023u);
+  EXPECT_EQ(histogram.GetQuantile(0.99), 1023u);
+  EXPECT_EQ(histogram.GetQuantile(1.0), 50000u);
+}
+
+TEST(LoopRunner, TicksAtTheConfiguredRate) {
+  Wrapper wrapper;
+  wrapper.OnHoveringCommandCallback();
+  LoopRunnerOptions options;
+  options.frequency = 500.0;
+  int num_controls = 0;
+  LoopRunner runner(wrapper, options, [&](const Control &control) {
+    EXPECT_EQ(control.phase, MotionPhase::kHovering);
+    num_controls++;
+  });
+
+  auto begin = std::chrono::steady_clock::now();
+  runner.RunFor(50);
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - begin)
+                       .count();
+  auto statistics = runner.GetStatistics();
+  EXPECT_EQ(num_controls, 50);
+  EXPECT_EQ(statistics.num_ticks, 50u);
+  EXPECT_EQ(statistics.jitter.GetNumSamples(), 50u);
+  EXPECT_EQ(statistics.execution.GetNumSamples(), 50u);
+  // absolute deadlines: 50 periods, however long each tick took
+  EXPECT_GE(elapsed, 50 / options.frequency);
+  EXPECT_FALSE(wrapper.IsDegraded());
+}
+
+TEST(LoopRunner, DetectsOverrunsAndDegrades) {
+  Wrapper wrapper;
+  LoopRunnerOptions options;
+  options.frequency = 1000.0;
+  bool was_degraded = false;
+  LoopRunner runner(wrapper, options, [&](const Control &) {
+    was_degraded |= wrapper.IsDegraded();
+    std::this_thread::sleep_for(std::chrono::milliseconds(3));
+  });
+  runner.RunFor(10);
+
+  auto statistics = runner.GetStatistics();
+  EXPECT_EQ(statistics.num_overruns, 10u);
+  EXPECT_GE(statistics.num_skipped_periods, 20u);
+  EXPECT_EQ(statistics.num_degraded_ticks, 9u);
+  EXPECT_GE(statistics.execution.GetQuantile(0.5), 2000000u);
+  EXPECT_TRUE(was_degraded);
+  EXPECT_FALSE(wrapper.IsDegraded());
+
+  options.degrade_policy = DegradePolicy::kNone;
+  LoopRunner undegraded(wrapper, options, [&](const Control &) {
+    EXPECT_FALSE(wrapper.IsDegraded());
+    std::this_thread::sleep_for(std::chrono::milliseconds(3));
+  });
+  undegraded.RunFor(3);
+  EXPECT_EQ(undegraded.GetStatistics().num_degraded_ticks, 0u);
+}
+
+TEST(LoopRunner, RunsOnItsOwnThreadUntilStopped) {
+  Wrapper wrapper;
+  LoopRunnerOptions options;
+  options.frequency = 1000.0;
+  options.cpu = sched_getcpu();
+  LoopRunner runner(wrapper, options);
+  ASSERT_TRUE(runner.Start());
+  EXPECT_FALSE(runner.Start());
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (runner.GetStatistics().num_ticks < 10 &&
+         std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  runner.Stop();
+  EXPECT_FALSE(runner.IsRunning());
+  EXPECT_TRUE(runner.IsPinned());
+
+  auto num_ticks = runner.GetStatistics().num_ticks;
+  EXPECT_GE(num_ticks, 10u);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_EQ(runner.GetStatistics().num_ticks, num_ticks);
+}
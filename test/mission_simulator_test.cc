@@ -0,0 +1,76 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/mission_simulator.h"
+#include <gtest/gtest.h>
+
+using namespace my_robotics_library;
+
+namespace {
+
+MissionSimulatorOptions ShortMissions() {
+  MissionSimulatorOptions options;
+  options.scenario.duration = 4.0;
+  options.scenario.chase_command_time = 1.0;
+  options.seed = 7;
+  return options;
+}
+
+} // namespace
+
+TEST(MissionSimulator, EpisodesAreReproducible) {
+  auto options = ShortMissions();
+  auto first = SimulateEpisode(options, 3);
+  auto second = SimulateEpisode(options, 3);
+  EXPECT_EQ(first.time_in_phase, second.time_in_phase);
+  EXPECT_EQ(first.num_chasing_plans, second.num_chasing_plans);
+  EXPECT_EQ(first.num_hold_stops, second.num_hold_stops);
+  EXPECT_GT(first.num_chasing_plans, 0);
+}
+
+TEST(MissionSimulator, StatisticsDoNotDependOnThreads) {
+  auto options = ShortMissions();
+  ThreadPool serial(1);
+  ThreadPool parallel(3);
+  auto expected = SimulateMissions(options, 40, serial);
+  auto actual = SimulateMissions(options, 40, parallel);
+  EXPECT_EQ(expected.num_episodes, 40u);
+  EXPECT_EQ(expected.mean_time_in_phase, actual.mean_time_in_phase);
+  EXPECT_EQ(expected.mean_chasing_plans, actual.mean_chasing_plans);
+  EXPECT_EQ(expected.mean_hold_stops, actual.mean_hold_stops);
+  EXPECT_EQ(expected.landing_rate, actual.landing_rate);
+}
+
+TEST(MissionSimulator, DrainedBatteryLands) {
+  auto options = ShortMissions();
+  options.scenario.max_num_obstacles = 0;
+  options.scenario.min_battery_drain = 60.0;
+  options.scenario.max_battery_drain = 80.0;
+  auto statistics = SimulateMissions(options, 8);
+  EXPECT_EQ(statistics.landing_rate, 1.0);
+  EXPECT_EQ(statistics.hold_stop_rate, 0.0);
+  EXPECT_GT(statistics.mean_time_in_phase[MotionPhase::kLanding], 0.0);
+
+  options.scenario.min_battery_drain = 0.0;
+  options.scenario.max_battery_drain = 0.0;
+  statistics = SimulateMissions(options, 8);
+  EXPECT_EQ(statistics.landing_rate, 0.0);
+  EXPECT_DOUBLE_EQ(statistics.mean_flight_time, options.scenario.duration);
+  EXPECT_GT(statistics.mean_time_in_phase[MotionPhase::kChasing], 0.0);
+}
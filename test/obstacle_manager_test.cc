@@ -0,0 +1,212 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/backend/obstacle_manager.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace my_robotics_library;
+using namespace my_robotics_library::backend;
+
+double BruteForceDistance(const std::vector<TimedPosition> &obstacles,
+                          const TimedPosition &query, double max_distance) {
+  double distance = max_distance;
+  for (const auto &obstacle : obstacles)
+    distance = std::min(distance, std::sqrt(std::pow(obstacle.x - query.x, 2) +
+                                            std::pow(obstacle.y - query.y, 2) +
+                                            std::pow(obstacle.z - query.z, 2)));
+  return distance;
+}
+
+TEST(ObstacleManager, MatchesBruteForceAfterEdits) {
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> coordinate(-20.0, 20.0);
+  auto random_position = [&]() -> TimedPosition {
+    return {0.0, coordinate(generator), coordinate(generator),
+            coordinate(generator)};
+  };
+
+  ObstacleManager obstacle_manager(0.5, 5.0);
+  std::vector<TimedPosition> positions(2000);
+  std::generate(positions.begin(), positions.end(), random_position);
+  std::vector<ObstacleId> ids;
+  obstacle_manager.InsertObstacles(positions, &ids);
+
+  // move the first quarter, remove the second quarter
+  std::vector<TimedPosition> expected;
+  for (size_t n = 0; n < ids.size(); n++) {
+    if (n < ids.size() / 4) {
+      auto moved = random_position();
+      EXPECT_TRUE(obstacle_manager.UpdateObstacle(ids[n], moved));
+      expected.push_back(moved);
+    } else if (n < ids.size() / 2) {
+      EXPECT_TRUE(obstacle_manager.RemoveObstacle(ids[n]));
+    } else {
+      expected.push_back(positions[n]);
+    }
+  }
+  EXPECT_FALSE(obstacle_manager.RemoveObstacle(ids[ids.size() / 2 - 1]));
+  EXPECT_EQ(obstacle_manager.GetNumObstacles(), expected.size());
+
+  for (int n = 0; n < 500; n++) {
+    auto query = random_position();
+    EXPECT_NEAR(obstacle_manager.GetDistanceToObstacle(query),
+                BruteForceDistance(expected, query, 5.0), 1e-9);
+  }
+}
+
+TEST(ObstacleManager, MatchesBruteForceInSparseMaps) {
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> coordinate(-15.0, 15.0);
+  auto random_position = [&]() -> TimedPosition {
+    return {0.0, coordinate(generator), coordinate(generator),
+            coordinate(generator)};
+  };
+
+  // few enough obstacles that far queries scan the occupied voxels instead
+  // of walking the empty shells
+  ObstacleManager obstacle_manager(0.5, 10.0);
+  for (size_t num_obstacles : {1, 5, 40}) {
+    obstacle_manager.Clear();
+    std::vector<TimedPosition> positions(num_obstacles);
+    std::generate(positions.begin(), positions.end(), random_position);
+    obstacle_manager.InsertObstacles(positions);
+    for (int n = 0; n < 200; n++) {
+      auto query = random_position();
+      EXPECT_NEAR(obstacle_manager.GetDistanceToObstacle(query),
+                  BruteForceDistance(positions, query, 10.0), 1e-9)
+          << num_obstacles << " obstacles";
+    }
+  }
+}
+
+TEST(ObstacleManager, SaturatesWhenNothingIsClose) {
+  ObstacleManager obstacle_manager(0.5, 3.0);
+  EXPECT_EQ(obstacle_manager.GetDistanceToObstacle({}), 3.0);
+  obstacle_manager.InsertObstacle({0, 10, 0, 0});
+  EXPECT_EQ(obstacle_manager.GetDistanceToObstacle({}), 3.0);
+  obstacle_manager.InsertObstacle({0, -1, -1, 1});
+  EXPECT_NEAR(obstacle_manager.GetDistanceToObstacle({}), std::sqrt(3.0),
+              1e-12);
+}
+
+TEST(ObstacleManager, DistanceFieldTracksIncrementalEdits) {
+  std::mt19937 generator(11);
+  std::uniform_real_distribution<double> coordinate(-4.0, 4.0);
+  auto random_position = [&]() -> TimedPosition {
+    return {0.0, coordinate(generator), coordinate(generator),
+            coordinate(generator) + 4.0};
+  };
+
+  DistanceFieldConfig config;
+  config.origin_x = -5.0;
+  config.origin_y = -5.0;
+  config.origin_z = -1.0;
+  config.resolution = 0.2;
+  config.size_x = config.size_y = config.size_z = 51;
+  config.truncation_distance = 0.8;
+
+  ObstacleManager obstacle_manager(0.5, 1.5);
+  std::vector<ObstacleId> ids;
+  for (int n = 0; n < 20; n++)
+    ids.push_back(obstacle_manager.InsertObstacle(random_position()));
+  obstacle_manager.EnableDistanceField(config);
+  for (int n = 0; n < 20; n++)
+    ids.push_back(obstacle_manager.InsertObstacle(random_position()));
+  for (int n = 0; n < 10; n++) {
+    obstacle_manager.RemoveObstacle(ids[n]);
+    obstacle_manager.UpdateObstacle(ids[n + 10], random_position());
+  }
+
+  const size_t n_query = 2000;
+  std::vector<double> xs(n_query), ys(n_query), zs(n_query), batch(n_query);
+  for (size_t n = 0; n < n_query; n++) {
+    auto query = random_position();
+    xs[n] = query.x;
+    ys[n] = query.y;
+    zs[n] = query.z;
+  }
+  obstacle_manager.GetDistancesToObstacle(xs.data(), ys.data(), zs.data(),
+                                          n_query, batch.data());
+  obstacle_manager.DisableDistanceField();
+  for (size_t n = 0; n < n_query; n++) {
+    double exact = std::min(
+        obstacle_manager.GetDistanceToObstacle({0, xs[n], ys[n], zs[n]}),
+        config.truncation_distance);
+    // interpolating a 1-Lipschitz function on a grid of spacing h
+    EXPECT_NEAR(batch[n], exact, config.resolution * std::sqrt(3.0));
+  }
+}
+
+TEST(ObstacleManager, DistanceFieldSaturatesAtTruncation) {
+  DistanceFieldConfig config;
+  config.origin_x = config.origin_y = config.origin_z = -2.0;
+  config.resolution = 0.2;
+  config.size_x = config.size_y = config.size_z = 21;
+  config.truncation_distance = 0.5;
+
+  ObstacleManager obstacle_manager(0.5, 3.0);
+  obstacle_manager.EnableDistanceField(config);
+  auto id = obstacle_manager.InsertObstacle({0, 0.0, 0.0, 0.0});
+  obstacle_manager.InsertObstacle({0, 1.0, 0.0, 0.0});
+  obstacle_manager.RemoveObstacle(id);
+
+  EXPECT_NEAR(obstacle_manager.GetDistanceToObstacle({0, 1.0, 0.2, 0.0}), 0.2,
+              1e-6);
+  // the removed obstacle no longer shows up within the truncation distance
+  EXPECT_DOUBLE_EQ(obstacle_manager.GetDistanceToObstacle({0, 0.0, 0.2, 0.0}),
+                   0.5);
+  EXPECT_DOUBLE_EQ(obstacle_manager.GetDistanceToObstacle({0, 1.0, 1.5, 0.0}),
+                   0.5);
+  // outside the grid the index answers up to the maximum query distance
+  EXPECT_DOUBLE_EQ(obstacle_manager.GetDistanceToObstacle({0, 1.0, 3.0, 0.0}),
+                   3.0);
+  EXPECT_DOUBLE_EQ(obstacle_manager.GetDistanceToObstacle({0, 1.0, 2.5, 0.0}),
+                   2.5);
+}
+
+TEST(ObstacleManager, ReportsFirstViolationAlongTrajectory) {
+  ObstacleManager obstacle_manager(0.5, 3.0);
+  obstacle_manager.InsertObstacle({0, 5.0, 0.5, 0});
+
+  // straight line along x sampled every 0.1 s at 1 m/s
+  std::vector<TimedPosition> line;
+  for (int n = 0; n <= 100; n++)
+    line.push_back({0.1 * n, 0.1 * n, 0, 0});
+  std::vector<TrajectorySamples> candidates(2);
+  candidates[0].Assign(line);
+  for (auto &position : line)
+    position.y = 5.0;
+  candidates[1].Assign(line);
+
+  std::vector<TrajectoryClearance> clearances;
+  obstacle_manager.CheckTrajectories(candidates, 1.0, clearances);
+  ASSERT_EQ(clearances.size(), 2);
+
+  EXPECT_TRUE(clearances[0].is_violated);
+  // the line enters the 1 m ball around the obstacle at x = 5 - sqrt(0.75)
+  EXPECT_NEAR(clearances[0].first_violation_time, 4.2, 1e-9);
+  EXPECT_NEAR(clearances[0].min_clearance, 0.5, 1e-9);
+  EXPECT_NEAR(clearances[0].min_clearance_time, 5.0, 1e-9);
+
+  EXPECT_FALSE(clearances[1].is_violated);
+  EXPECT_NEAR(clearances[1].min_clearance, 3.0, 1e-9);
+}
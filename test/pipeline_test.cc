@@ -58,6 +58,7 @@ TEST(MonitorEvent, ShouldHoldStopWhenNotSafe) {
   auto control = wrapper.GetControl();
   EXPECT_EQ(control.phase, MotionPhase::kHovering);
 
+  wrapper.GetObstacleManager().InsertObstacle({0, 2.5, 0, 0});
   TimedPosition dangerous_position{0, 2, 0, 0};
   wrapper.SetPosition(dangerous_position);
   wrapper.OnTimerCallback();
@@ -71,8 +72,27 @@ TEST(MonitorEvent, ShouldHoldStopWhenNotSafe) {
   EXPECT_EQ(control.phase, MotionPhase::kHovering);
 }
 
-TEST(MonitorEvent, ChasingAndExploration) {
+TEST(MonitorEvent, ShouldHoldStopWhenPlanIsNotSafe) {
   Wrapper wrapper;
+  // current position is clear, but the hovering plan climbs into it
+  wrapper.GetObstacleManager().InsertObstacle({0, 0, 0, 1.5});
+
+  // the command's transitions are checked by the monitor in the same call
+  wrapper.OnHoveringCommandCallback();
+  EXPECT_EQ(wrapper.GetControl().phase, MotionPhase::kHolding);
+  EXPECT_EQ(wrapper.GetStateHistory().Previous().motion_phase,
+            MotionPhase::kHovering);
+
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetControl().phase, MotionPhase::kHolding);
+}
+
+TEST(MonitorEvent, ChasingAndExploration) {
+  auto clock = std::make_shared<SimulatedClock>();
+  // chase the detections as they are; see TargetPrediction for the default
+  Parameter parameter;
+  parameter.use_target_prediction = false;
+  Wrapper wrapper(parameter, clock);
 
   wrapper.OnHoveringCommandCallback();
   auto control = wrapper.GetControl();
@@ -92,11 +112,18 @@ TEST(MonitorEvent, ChasingAndExploration) {
 
   // Chasing should re-planned after 0.2 sec
   wrapper.SetTargetPosition(TimedPosition{2, 1, 0, 0});
-  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  clock->Advance(0.3);
   wrapper.OnTimerCallback();
   control = wrapper.GetControl();
   EXPECT_EQ(control.phase, MotionPhase::kChasing);
-  EXPECT_EQ(control.input, 1.0);
+  // the trajectory starts from the robot and reaches the target smoothly
+  EXPECT_EQ(control.input, 0.0);
+  clock->Advance(0.5 * Parameter().chasing_horizon);
+  control = wrapper.GetControl();
+  EXPECT_GT(control.input, 0.0);
+  EXPECT_LT(control.input, 1.0);
+  clock->Advance(0.5 * Parameter().chasing_horizon);
+  EXPECT_NEAR(wrapper.GetControl().input, 1.0, 1e-9);
 
   // When target is lost, change to exploration phase
   wrapper.SetTargetPosition(std::nullopt);
@@ -109,7 +136,221 @@ TEST(MonitorEvent, ChasingAndExploration) {
   wrapper.OnTimerCallback();
   control = wrapper.GetControl();
   EXPECT_EQ(control.phase, MotionPhase::kChasing);
-  EXPECT_EQ(control.input, 2.0);
+  clock->Advance(Parameter().chasing_horizon);
+  EXPECT_NEAR(wrapper.GetControl().input, 2.0, 1e-9);
+}
+
+TEST(TargetPrediction, ChasesWhereTargetWillBe) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(clock);
+  wrapper.OnHoveringCommandCallback();
+
+  // target walks along x at 0.5 m/s, detected every 0.1 s
+  for (int n = 0; n <= 10; n++) {
+    clock->SetTime(0.1 * n);
+    wrapper.SetTargetPosition(TimedPosition{0.1 * n, 0.05 * n, 1.0, 0.0});
+    wrapper.OnTimerCallback();
+  }
+  wrapper.OnChasingCommandCallback();
+  ASSERT_EQ(wrapper.GetControl().phase, MotionPhase::kChasing);
+
+  // at the end of the horizon the plan meets the target, not its last sighting
+  const double horizon = Parameter().chasing_horizon;
+  clock->Advance(horizon);
+  EXPECT_NEAR(wrapper.GetControl().input, 0.5 + 0.5 * horizon, 0.05);
+  // and keeps moving with it
+  clock->Advance(0.5);
+  EXPECT_NEAR(wrapper.GetControl().input, 0.75 + 0.5 * horizon, 0.05);
+}
+
+TEST(TargetPrediction, ChasesLastSightingOfTargetOnAnotherTimeBase) {
+  for (double offset : {1e9, -1e9}) {
+    auto clock = std::make_shared<SimulatedClock>();
+    Wrapper wrapper(clock);
+    wrapper.OnHoveringCommandCallback();
+
+    // same walk as above, but stamped by a camera clock far off the Wrapper's
+    for (int n = 0; n <= 10; n++) {
+      clock->SetTime(0.1 * n);
+      wrapper.SetTargetPosition(
+          TimedPosition{offset + 0.1 * n, 0.05 * n, 1.0, 0.0});
+      wrapper.OnTimerCallback();
+    }
+    wrapper.OnChasingCommandCallback();
+    ASSERT_EQ(wrapper.GetControl().phase, MotionPhase::kChasing);
+
+    // treated as lost: the plan aims at the sighting instead of extrapolating
+    clock->Advance(Parameter().chasing_horizon);
+    EXPECT_NEAR(wrapper.GetControl().input, 0.5, 0.05) << offset;
+  }
+}
+
+TEST(PlanningResult, SamplesIntoCallerBuffer) {
+  backend::HeightPlanner height_planner;
+  height_planner.SetRobotPosition({0, 1, 2, 0});
+  backend::HeightPlannerInput input;
+  input.target_height = 1.5;
+  auto height_plan = height_planner.ComputeHeightMotion(input);
+
+  TimedPosition samples[5];
+  height_plan.SampleTrajectory(10.0, 0.5, 5, samples);
+  EXPECT_EQ(samples[4].t, 12.0);
+  EXPECT_EQ(samples[4].x, 1.0);
+  EXPECT_EQ(samples[4].z, 1.5);
+
+  backend::MotionPlanningResultStore result_store;
+  height_planner.ComputeHeightMotion(input, result_store);
+  TrajectorySamples soa_samples;
+  soa_samples.Resize(5);
+  result_store.SampleTrajectory(10.0, 0.5, soa_samples);
+  for (size_t n = 0; n < 5; n++) {
+    EXPECT_EQ(soa_samples.t[n], samples[n].t);
+    EXPECT_EQ(soa_samples.y[n], samples[n].y);
+    EXPECT_EQ(soa_samples.z[n], samples[n].z);
+  }
+
+  auto trajectory = height_plan.GetPlanningTrajectory(0.0, 3.0);
+  ASSERT_EQ(trajectory.size(), MotionPlanningResult::kDefaultNumSamples);
+  EXPECT_NEAR(trajectory[1].t, 0.1, 1e-12);
+}
+
+TEST(PlanningResult, ChasingTrajectoryMeetsBoundaryConditions) {
+  auto clock = std::make_shared<SimulatedClock>(5.0);
+  backend::ChasingPlanner chasing_planner(clock);
+  backend::ChasingPlannerInput input;
+  input.robot_position = {5.0, 0.0, 1.0, 1.0};
+  input.robot_velocity = {5.0, 1.0, -0.5, 0.0};
+  input.target_position = {5.0, 3.0, 2.0, 1.0};
+  input.horizon = 2.0;
+  auto plan = chasing_planner.ComputeChasingMotion(input);
+
+  auto start = plan.EvaluatePosition(5.0);
+  EXPECT_NEAR(start.x, 0.0, 1e-12);
+  EXPECT_NEAR(start.y, 1.0, 1e-12);
+  const double h = 1e-6;
+  EXPECT_NEAR((plan.EvaluatePosition(5.0 + h).x - start.x) / h, 1.0, 1e-4);
+  EXPECT_NEAR((plan.EvaluatePosition(5.0 + h).y - start.y) / h, -0.5, 1e-4);
+
+  for (double t : {7.0, 9.0}) {
+    auto end = plan.EvaluatePosition(t);
+    EXPECT_NEAR(end.x, 3.0, 1e-9);
+    EXPECT_NEAR(end.y, 2.0, 1e-9);
+    EXPECT_NEAR(end.z, 1.0, 1e-9);
+  }
+  EXPECT_NEAR(plan.GenerateControl(7.0).input, 3.0, 1e-9);
+}
+
+TEST(AsyncPlanning, ServesLastPlanUntilNewPlanIsReady) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Parameter parameter;
+  parameter.use_async_chasing_planner = true;
+  parameter.use_target_prediction = false;
+  Wrapper wrapper(parameter, clock);
+
+  wrapper.OnHoveringCommandCallback();
+  wrapper.SetPosition({0, 0, 0, 0.5});
+  EXPECT_GT(wrapper.GetControl().input, 0.0);
+  wrapper.SetTargetPosition(TimedPosition{1, 3, 0, 0});
+  wrapper.OnChasingCommandCallback();
+
+  // until the worker delivers, the chase commands nothing rather than the
+  // hovering plan's height error
+  auto control = wrapper.GetControl();
+  EXPECT_EQ(control.phase, MotionPhase::kChasing);
+  EXPECT_EQ(control.input, 0.0);
+
+  // waits until the served plan ends at the given view position
+  auto wait_for_view_x = [&](double view_x) {
+    for (int n = 0; n < 1000; n++) {
+      wrapper.OnTimerCallback();
+      const auto *plan = wrapper.GetMotionPlanningResult().Get();
+      if (plan && plan->GetMotionType() == MotionPhase::kChasing) {
+        TimedPosition end;
+        plan->SampleTrajectory(
+            plan->GetRequestTime() + parameter.chasing_horizon, 0.0, 1, &end);
+        if (end.x == view_x)
+          return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+  };
+  EXPECT_TRUE(wait_for_view_x(3.0));
+  EXPECT_EQ(wrapper.GetControl().phase, MotionPhase::kChasing);
+
+  // a moved target supersedes the plan in flight
+  wrapper.SetTargetPosition(TimedPosition{2, 4, 0, 0});
+  clock->Advance(0.3);
+  EXPECT_TRUE(wait_for_view_x(4.0));
+
+  // losing the target still switches to exploration synchronously
+  wrapper.SetTargetPosition(std::nullopt);
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetControl().phase, MotionPhase::kExploration);
+}
+
+TEST(AsyncPlanning, DropsThePlanInFlightWhenChasingIsLeft) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Parameter parameter;
+  parameter.use_async_chasing_planner = true;
+  parameter.use_target_prediction = false;
+  Wrapper wrapper(parameter, clock);
+
+  wrapper.OnHoveringCommandCallback();
+  wrapper.SetTargetPosition(TimedPosition{0, 3, 0, 0});
+  wrapper.OnChasingCommandCallback();
+  // let the worker finish the chase, then leave it before the next tick
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  wrapper.OnHoveringCommandCallback();
+  for (int n = 0; n < 5; n++) {
+    clock->Advance(0.01);
+    wrapper.OnTimerCallback();
+  }
+  EXPECT_EQ(wrapper.GetMotionPlanningResult().Get()->GetMotionType(),
+            MotionPhase::kHovering);
+  EXPECT_EQ(wrapper.GetControl().phase, MotionPhase::kHovering);
+
+  // chasing the same target again plans from where the robot is now rather
+  // than serving the dropped plan
+  wrapper.SetPosition({clock->Now(), 1, 0, 0});
+  wrapper.OnChasingCommandCallback();
+  bool is_planned = false;
+  for (int n = 0; n < 1000 && !is_planned; n++) {
+    wrapper.OnTimerCallback();
+    const auto *plan = wrapper.GetMotionPlanningResult().Get();
+    is_planned = plan->GetMotionType() == MotionPhase::kChasing;
+    if (!is_planned)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(is_planned);
+  const auto *plan = wrapper.GetMotionPlanningResult().Get();
+  TimedPosition start;
+  plan->SampleTrajectory(plan->GetRequestTime(), 0.0, 1, &start);
+  EXPECT_EQ(start.x, 1.0);
+}
+
+TEST(AsyncPlanning, SamplingPlansExcludeObstacleEdits) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Parameter parameter;
+  parameter.use_async_chasing_planner = true;
+  parameter.use_sampling_chasing_planner = true;
+  parameter.use_target_prediction = false;
+  Wrapper wrapper(parameter, clock);
+
+  wrapper.OnHoveringCommandCallback();
+  wrapper.SetTargetPosition(TimedPosition{0, 3, 0, 0});
+  wrapper.OnChasingCommandCallback();
+  // edits race with the plans scored on the worker unless locked out
+  for (int n = 0; n < 50; n++) {
+    {
+      auto lock = wrapper.LockObstacles();
+      wrapper.GetObstacleManager().InsertObstacle({0, 3, 0.1 * n, 2.0});
+    }
+    wrapper.SetTargetPosition(TimedPosition{clock->Now(), 3 + 0.1 * n, 0, 0});
+    clock->Advance(0.3);
+    wrapper.OnTimerCallback();
+  }
+  EXPECT_EQ(wrapper.GetControl().phase, MotionPhase::kChasing);
 }
 
 int main(int argc, char **argv) {
@@ -0,0 +1,165 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/backend/point_cloud_ingestor.h"
+#include "my_robotics_library/frontend/wrapper.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <set>
+#include <thread>
+#include <tuple>
+
+using namespace my_robotics_library;
+using namespace my_robotics_library::backend;
+
+namespace {
+
+PointCloudView ToView(const std::vector<float> &xyz) {
+  return {xyz.data(), xyz.size() / 3, 3 * sizeof(float)};
+}
+
+// points on a 1 m x 1 m patch of wall at x = distance
+std::vector<float> MakeWall(double distance, size_t num_points) {
+  std::vector<float> xyz;
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<float> coordinate(-0.5f, 0.5f);
+  for (size_t n = 0; n < num_points; n++) {
+    xyz.push_back(static_cast<float>(distance));
+    xyz.push_back(coordinate(generator));
+    xyz.push_back(1.0f + coordinate(generator));
+  }
+  return xyz;
+}
+
+} // namespace
+
+TEST(PointCloudIngestor, DownsamplesLikeBruteForce) {
+  ObstacleManager obstacle_manager;
+  PointCloudParameter parameter;
+  ThreadPool thread_pool(3);
+  PointCloudIngestor ingestor(obstacle_manager, parameter, thread_pool);
+
+  // several chunks of points, with non-finite ones mixed in
+  std::mt19937 generator(11);
+  std::uniform_real_distribution<float> coordinate(-3.0f, 3.0f);
+  std::vector<float> xyz;
+  std::set<std::tuple<int, int, int>> expected;
+  for (size_t n = 0; n < 100000; n++) {
+    float x = coordinate(generator), y = coordinate(generator),
+          z = coordinate(generator);
+    if (n % 1000 == 0)
+      x = std::numeric_limits<float>::quiet_NaN();
+    else
+      expected.emplace(static_cast<int>(std::floor(x / 0.2)),
+                       static_cast<int>(std::floor(y / 0.2)),
+                       static_cast<int>(std::floor(z / 0.2)));
+    xyz.insert(xyz.end(), {x, y, z});
+  }
+  EXPECT_EQ(ingestor.Downsample(ToView(xyz)), expected.size());
+
+  // the same points inside larger structs
+  struct PointXYZI {
+    float x, y, z, intensity;
+  };
+  std::vector<PointXYZI> points;
+  for (size_t n = 0; n < xyz.size(); n += 3)
+    points.push_back({xyz[n], xyz[n + 1], xyz[n + 2], 1.0f});
+  PointCloudView strided{&points[0].x, points.size(), sizeof(PointXYZI)};
+  EXPECT_EQ(ingestor.Downsample(strided), expected.size());
+
+  EXPECT_EQ(ingestor.Downsample(PointCloudView()), 0u);
+}
+
+TEST(PointCloudIngestor, KeepsASlidingWindowOfObservations) {
+  ObstacleManager obstacle_manager;
+  PointCloudParameter parameter;
+  parameter.window = 1.0;
+  PointCloudIngestor ingestor(obstacle_manager, parameter);
+
+  auto near_wall = MakeWall(2.0, 5000);
+  auto far_wall = MakeWall(6.0, 5000);
+  ingestor.Ingest(ToView(near_wall), 0.0);
+  // 5 x 5 voxels of 0.2 m, plus the borders the patch touches
+  size_t num_voxels = ingestor.GetNumObservedVoxels();
+  EXPECT_GE(num_voxels, 25u);
+  EXPECT_EQ(obstacle_manager.GetNumObstacles(), num_voxels);
+  EXPECT_NEAR(obstacle_manager.GetDistanceToObstacle({0, 0, 0, 1}), 2.1, 0.1);
+
+  // seen again: refreshed, not duplicated
+  ingestor.Ingest(ToView(near_wall), 0.5);
+  EXPECT_EQ(obstacle_manager.GetNumObstacles(), num_voxels);
+
+  ingestor.Ingest(ToView(far_wall), 1.2);
+  EXPECT_EQ(obstacle_manager.GetNumObstacles(), 2 * num_voxels);
+  // the near wall was last seen at 0.5
+  ingestor.Ingest(ToView(far_wall), 1.6);
+  EXPECT_EQ(obstacle_manager.GetNumObstacles(), num_voxels);
+  EXPECT_NEAR(obstacle_manager.GetDistanceToObstacle({0, 0, 0, 1}), 6.1, 0.1);
+
+  ingestor.Ingest(PointCloudView(), 3.0);
+  EXPECT_EQ(obstacle_manager.GetNumObstacles(), 0u);
+  EXPECT_EQ(ingestor.GetNumObservedVoxels(), 0u);
+}
+
+TEST(PointCloudIngestor, MergesInSlices) {
+  ObstacleManager obstacle_manager;
+  PointCloudParameter parameter;
+  parameter.merge_slice = 8;
+  PointCloudIngestor ingestor(obstacle_manager, parameter);
+
+  auto wall = MakeWall(2.0, 1000);
+  size_t num_voxels = ingestor.Downsample(ToView(wall));
+  size_t num_slices = 1;
+  while (!ingestor.MergeSlice(0.0))
+    num_slices++;
+  EXPECT_EQ(num_slices, (num_voxels + 7) / 8);
+  EXPECT_EQ(obstacle_manager.GetNumObstacles(), num_voxels);
+}
+
+TEST(PointCloudIngestor, WrapperIngestsWhileTicking) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Wrapper wrapper(clock);
+  wrapper.SetPosition({0, 0, 0, 1});
+  wrapper.OnHoveringCommandCallback();
+
+  std::atomic<bool> is_done{false};
+  std::thread sensor([&] {
+    auto far_wall = MakeWall(8.0, 20000);
+    for (int frame = 0; frame < 20; frame++)
+      wrapper.IngestPointCloud(ToView(far_wall), 0.0);
+    is_done.store(true);
+  });
+  while (!is_done.load()) {
+    wrapper.OnTimerCallback();
+    EXPECT_EQ(wrapper.GetStateHistory().Back().motion_phase,
+              MotionPhase::kHovering);
+  }
+  sensor.join();
+
+  // a wall within the safety distance stops the vehicle
+  auto near_wall = MakeWall(0.5, 20000);
+  wrapper.IngestPointCloud(ToView(near_wall), 0.0);
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetStateHistory().Back().motion_phase,
+            MotionPhase::kHolding);
+}
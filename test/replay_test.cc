@@ -0,0 +1,196 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/replay.h"
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace my_robotics_library;
+
+namespace {
+
+// hover, climb, chase a walking target, lose it and find it again. wait
+// moves the clock on between ticks
+void RecordFlight(const std::string &path, std::shared_ptr<const Clock> clock,
+                  const std::function<void()> &wait) {
+  FlightRecorder flight_recorder;
+  ASSERT_TRUE(flight_recorder.Open(path, 4096));
+  Wrapper wrapper(clock);
+  wrapper.SetFlightRecorder(&flight_recorder);
+
+  wrapper.OnHoveringCommandCallback();
+  for (int n = 0; n < 100; n++) {
+    wait();
+    wrapper.SetPosition({clock->Now(), 0, 0, 0.01 * n});
+    if (n == 20)
+      wrapper.OnChasingCommandCallback();
+    if (n >= 10 && (n < 50 || n > 60))
+      wrapper.SetTargetPosition(
+          TimedPosition{clock->Now(), 2 + 0.5 * (0.01 * n), 1, 0});
+    else
+      wrapper.SetTargetPosition(std::nullopt);
+    wrapper.OnTimerCallback();
+    wrapper.GetControl();
+  }
+}
+
+void RecordFlight(const std::string &path) {
+  auto clock = std::make_shared<SimulatedClock>();
+  RecordFlight(path, clock, [&] { clock->Advance(0.01); });
+}
+
+// Copies a log as if a sensor thread had set the position right after every
+// tick record, before the tick read its snapshot
+void InterleavePositions(const FlightLogReader &log, const std::string &path) {
+  FlightRecorder copy;
+  ASSERT_TRUE(copy.Open(path, 2 * log.Size()));
+  for (size_t n = 0; n < log.Size(); n++) {
+    const auto &record = log[n];
+    switch (record.GetType()) {
+    case FlightRecordType::kSensor:
+      copy.RecordSensor(record.t, ToSensorInformation(record));
+      break;
+    case FlightRecordType::kMonitorEvent:
+      copy.RecordMonitorEvent(record.t,
+                              static_cast<MonitorEvent>(record.value));
+      break;
+    case FlightRecordType::kTransition:
+      copy.RecordTransition(record.t,
+                            static_cast<MotionPhase>(record.previous),
+                            static_cast<MotionPhase>(record.value));
+      break;
+    case FlightRecordType::kControl:
+      copy.RecordControl(record.t, ToControl(record));
+      break;
+    case FlightRecordType::kPosition:
+      copy.RecordPosition(record.t, {record.data[0], record.data[1],
+                                     record.data[2], record.data[3]});
+      break;
+    default:
+      copy.RecordCommand(record.GetType(), record.t);
+      break;
+    }
+    if (record.GetType() == FlightRecordType::kTimerTick &&
+        n + 1 < log.Size())
+      copy.RecordPosition(record.t,
+                          ToSensorInformation(log[n + 1]).position);
+  }
+}
+
+} // namespace
+
+TEST(Replay, ReproducesRecordedDecisions) {
+  std::string path = testing::TempDir() + "replay_test.log";
+  RecordFlight(path);
+  FlightLogReader baseline;
+  ASSERT_TRUE(baseline.Open(path));
+
+  auto result = ReplayFlightLog(baseline, ReplayOptions());
+  EXPECT_TRUE(result.is_loaded);
+  EXPECT_FALSE(result.is_diverged);
+  EXPECT_EQ(result.num_callbacks, 102);
+  EXPECT_GT(result.num_compared, 100);
+  std::remove(path.c_str());
+}
+
+// every clock read of a callback sees the time recorded for it, so a log
+// recorded in real time replays exactly as well
+TEST(Replay, ReproducesDecisionsRecordedOnTheSystemClock) {
+  std::string path = testing::TempDir() + "replay_system_clock_test.log";
+  RecordFlight(path, GetDefaultClock(), [] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(3));
+  });
+  FlightLogReader baseline;
+  ASSERT_TRUE(baseline.Open(path));
+
+  auto result = ReplayFlightLog(baseline, ReplayOptions());
+  EXPECT_FALSE(result.is_diverged)
+      << "at " << result.divergence_index << ": t " << result.expected.t
+      << " vs " << result.actual.t << ", phase " << result.expected.phase
+      << " vs " << result.actual.phase;
+  EXPECT_EQ(result.num_callbacks, 102);
+  EXPECT_GT(result.num_compared, 100);
+  std::remove(path.c_str());
+}
+
+TEST(Replay, FindsSnapshotsBehindPositionsOfOtherThreads) {
+  std::string path = testing::TempDir() + "replay_interleaved_test.log";
+  std::string interleaved_path =
+      testing::TempDir() + "replay_interleaved_copy_test.log";
+  RecordFlight(path);
+  {
+    FlightLogReader log;
+    ASSERT_TRUE(log.Open(path));
+    InterleavePositions(log, interleaved_path);
+  }
+  FlightLogReader baseline;
+  ASSERT_TRUE(baseline.Open(interleaved_path));
+
+  auto result = ReplayFlightLog(baseline, ReplayOptions());
+  EXPECT_FALSE(result.is_diverged)
+      << "at " << result.divergence_index << ": phase "
+      << result.expected.phase << " vs " << result.actual.phase;
+  EXPECT_EQ(result.num_callbacks, 102);
+  std::remove(path.c_str());
+  std::remove(interleaved_path.c_str());
+}
+
+TEST(Replay, ReportsFirstDivergence) {
+  std::string path = testing::TempDir() + "replay_divergence_test.log";
+  RecordFlight(path);
+  FlightLogReader baseline;
+  ASSERT_TRUE(baseline.Open(path));
+
+  ReplayOptions options;
+  options.parameter.hovering_height = 2.0;
+  auto result = ReplayFlightLog(baseline, options);
+  ASSERT_TRUE(result.is_diverged);
+  // the idle -> hovering transition still matches, its control does not
+  EXPECT_EQ(result.divergence_index, 1);
+  EXPECT_EQ(result.expected.type, FlightRecordType::kControl);
+  EXPECT_EQ(result.actual.phase, MotionPhase::kHovering);
+  EXPECT_NE(result.expected.input, result.actual.input);
+  std::remove(path.c_str());
+}
+
+TEST(Replay, ReplaysManyLogsInParallel) {
+  std::vector<std::string> paths;
+  for (int n = 0; n < 8; n++) {
+    paths.push_back(testing::TempDir() + "replay_parallel_" +
+                    std::to_string(n) + ".log");
+    RecordFlight(paths.back());
+  }
+  paths.push_back(testing::TempDir() + "replay_missing.log");
+
+  ThreadPool thread_pool(3);
+  auto results = ReplayFlightLogs(paths, ReplayOptions(), thread_pool);
+  ASSERT_EQ(results.size(), paths.size());
+  for (int n = 0; n < 8; n++) {
+    EXPECT_TRUE(results[n].is_loaded);
+    EXPECT_FALSE(results[n].is_diverged);
+    std::remove(paths[n].c_str());
+  }
+  EXPECT_FALSE(results.back().is_loaded);
+}
@@ -0,0 +1,104 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/backend/seqlock.h"
+#include "my_robotics_library/frontend/wrapper.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace my_robotics_library;
+
+TEST(SensorIngestion, SeqLockHasNoTornReads) {
+  SeqLock<SensorInformation> buffer;
+  std::atomic<bool> stop{false};
+
+  // every writer keeps all fields equal, so a torn read shows up as a mismatch
+  auto writer = [&](double offset) {
+    for (double k = offset; !stop.load(); k += 1.0) {
+      buffer.Update([&](SensorInformation &sensor) {
+        sensor.position = {k, k, k, k};
+        sensor.velocity = {k, k, k, k};
+        sensor.target_position = TimedPosition{k, k, k, k};
+      });
+    }
+  };
+  std::thread writer_a(writer, 0.0);
+  std::thread writer_b(writer, 0.5);
+
+  const int n_read = 50000;
+  std::vector<double> latency_us;
+  latency_us.reserve(n_read);
+  int n_torn = 0;
+  for (int n = 0; n < n_read; n++) {
+    auto t_begin = std::chrono::steady_clock::now();
+    auto sensor = buffer.Load();
+    auto t_end = std::chrono::steady_clock::now();
+    latency_us.push_back(
+        std::chrono::duration<double, std::micro>(t_end - t_begin).count());
+
+    double k = sensor.position.t;
+    bool consistent = sensor.position.x == k && sensor.position.y == k &&
+                      sensor.position.z == k && sensor.velocity.t == k &&
+                      sensor.velocity.z == k &&
+                      sensor.target_position.has_value() &&
+                      sensor.target_position->z == k;
+    if (sensor.position.t != 0.0 && !consistent)
+      n_torn++;
+  }
+  stop = true;
+  writer_a.join();
+  writer_b.join();
+
+  std::sort(latency_us.begin(), latency_us.end());
+  double p99 = latency_us[static_cast<size_t>(0.99 * n_read)];
+  RecordProperty("read_latency_p99_us", std::to_string(p99));
+  RecordProperty("read_latency_max_us", std::to_string(latency_us.back()));
+
+  EXPECT_EQ(n_torn, 0);
+  EXPECT_LT(p99, 1000.0);
+}
+
+TEST(SensorIngestion, SettersRaceWithTimerTick) {
+  Wrapper wrapper;
+  wrapper.OnHoveringCommandCallback();
+  std::atomic<bool> stop{false};
+
+  std::thread position_thread([&] {
+    for (int n = 0; !stop.load(); n++)
+      wrapper.SetPosition({0.0, 0.0, 0.0, 0.001 * (n % 100)});
+  });
+  std::thread battery_thread([&] {
+    while (!stop.load())
+      wrapper.SetBatteryLevel(1);
+  });
+
+  for (int n = 0; n < 5000; n++) {
+    wrapper.OnTimerCallback();
+    auto control = wrapper.GetControl();
+    ASSERT_EQ(control.phase, MotionPhase::kHovering);
+    ASSERT_GE(control.input, 0.0);
+  }
+  stop = true;
+  position_thread.join();
+  battery_thread.join();
+}
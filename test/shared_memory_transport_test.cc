@@ -0,0 +1,237 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/frontend/shared_memory_transport.h"
+#include "my_robotics_library/frontend/wrapper.h"
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace my_robotics_library;
+
+namespace {
+std::string GetChannelName(const char *test) {
+  return "/mrl_" + std::string(test) + "_" + std::to_string(getpid());
+}
+
+std::vector<WrapperOutputMessage> ReceiveAll(SharedMemoryClient &client) {
+  std::vector<WrapperOutputMessage> messages;
+  WrapperOutputMessage message;
+  while (client.Receive(message))
+    messages.push_back(message);
+  return messages;
+}
+} // namespace
+
+TEST(SharedMemoryChannel, OpensOnlyCompatibleSegments) {
+  auto name = GetChannelName("open");
+  SharedMemoryChannel channel;
+  EXPECT_FALSE(channel.Open(name));
+
+  SharedMemoryChannel server;
+  ASSERT_TRUE(server.Create(name));
+  ASSERT_TRUE(channel.Open(name));
+  // two mappings of the same rings
+  EXPECT_NE(&channel.GetSensorRing(), &server.GetSensorRing());
+  SensorMessage message;
+  message.battery_level = 42;
+  ASSERT_TRUE(channel.GetSensorRing().TryPush(message));
+  ASSERT_TRUE(server.GetSensorRing().TryPop(message));
+  EXPECT_EQ(message.battery_level, 42);
+
+  // the creator removes the name; mappings stay usable
+  server.Close();
+  SharedMemoryChannel late;
+  EXPECT_FALSE(late.Open(name));
+  EXPECT_TRUE(channel.GetSensorRing().TryPush(message));
+}
+
+TEST(SharedMemoryChannel, ReplacesOnlySegmentsOfExitedCreators) {
+  auto name = GetChannelName("create");
+  SharedMemoryChannel server;
+  ASSERT_TRUE(server.Create(name));
+  SharedMemoryChannel channel;
+  ASSERT_TRUE(channel.Open(name));
+
+  // a second wrapper must not take over a segment that is still served
+  SharedMemoryChannel intruder;
+  EXPECT_FALSE(intruder.Create(name));
+  SensorMessage message;
+  message.battery_level = 42;
+  ASSERT_TRUE(channel.GetSensorRing().TryPush(message));
+  ASSERT_TRUE(server.GetSensorRing().TryPop(message));
+  EXPECT_EQ(message.battery_level, 42);
+  server.Close();
+  channel.Close();
+
+  // a creator that exits without closing leaves its segment behind
+  pid_t child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    SharedMemoryChannel crashed;
+    _exit(crashed.Create(name) ? 0 : 1);
+  }
+  int status = 0;
+  ASSERT_EQ(waitpid(child, &status, 0), child);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+  ASSERT_TRUE(channel.Open(name));
+  channel.Close();
+  EXPECT_TRUE(server.Create(name));
+}
+
+TEST(SharedMemoryWrapperAdaptor, DrivesTheWrapperThroughTheRings) {
+  auto name = GetChannelName("adaptor");
+  auto clock = std::make_shared<SimulatedClock>(1.0);
+  Wrapper wrapper(clock);
+  SharedMemoryChannel server;
+  ASSERT_TRUE(server.Create(name));
+  SharedMemoryWrapperAdaptor adaptor(wrapper, server);
+  SharedMemoryChannel channel;
+  ASSERT_TRUE(channel.Open(name));
+  SharedMemoryClient client(channel);
+
+  ASSERT_TRUE(client.SendPosition({1.0, 0, 0, 0.2}));
+  ASSERT_TRUE(client.SendBatteryLevel(80));
+  ASSERT_TRUE(client.SendHoveringCommand());
+  EXPECT_EQ(adaptor.Poll(), 3u);
+  clock->Advance(0.1);
+  wrapper.OnTimerCallback();
+  adaptor.Publish();
+  EXPECT_EQ(wrapper.GetStateHistory().Back().motion_phase,
+            MotionPhase::kHovering);
+
+  auto messages = ReceiveAll(client);
+  ASSERT_EQ(messages.size(), 2u);
+  EXPECT_EQ(messages[0].type, WrapperOutputType::kTransition);
+  EXPECT_EQ(messages[0].previous, MotionPhase::kIdle);
+  EXPECT_EQ(messages[0].phase, MotionPhase::kHovering);
+  EXPECT_DOUBLE_EQ(messages[0].t, 1.1);
+  auto control = wrapper.GetControl();
+  EXPECT_EQ(messages[1].type, WrapperOutputType::kControl);
+  EXPECT_EQ(messages[1].phase, MotionPhase::kHovering);
+  EXPECT_DOUBLE_EQ(messages[1].t, control.t);
+  EXPECT_DOUBLE_EQ(messages[1].input, control.input);
+
+  // without a transition only the control goes out
+  clock->Advance(0.1);
+  adaptor.Step();
+  messages = ReceiveAll(client);
+  ASSERT_EQ(messages.size(), 1u);
+  EXPECT_EQ(messages[0].type, WrapperOutputType::kControl);
+
+  ASSERT_TRUE(client.SendTargetPosition({1.2, 3.0, 0, 1.0}));
+  ASSERT_TRUE(client.SendChasingCommand());
+  clock->Advance(0.1);
+  adaptor.Step();
+  ASSERT_TRUE(client.SendTargetLost());
+  clock->Advance(0.1);
+  adaptor.Step();
+  messages = ReceiveAll(client);
+  std::vector<MotionPhase> phases;
+  for (const auto &message : messages)
+    if (message.type == WrapperOutputType::kTransition)
+      phases.push_back(static_cast<MotionPhase>(message.phase));
+  EXPECT_EQ(phases, (std::vector<MotionPhase>{MotionPhase::kChasing,
+                                              MotionPhase::kExploration}));
+  EXPECT_EQ(messages.back().phase, MotionPhase::kExploration);
+  EXPECT_EQ(adaptor.GetNumDropped(), 0u);
+}
+
+TEST(SharedMemoryWrapperAdaptor, ServesAFrontendInAnotherProcess) {
+  auto name = GetChannelName("process");
+  auto clock = std::make_shared<SimulatedClock>(1.0);
+  Wrapper wrapper(clock);
+  SharedMemoryChannel server;
+  ASSERT_TRUE(server.Create(name));
+  SharedMemoryWrapperAdaptor adaptor(wrapper, server);
+
+  pid_t child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    // the frontend maps the segment by name like an unrelated process
+    SharedMemoryChannel channel;
+    if (!channel.Open(name))
+      _exit(1);
+    SharedMemoryClient client(channel);
+    client.SendPosition({1.0, 0, 0, 0.2});
+    client.SendHoveringCommand();
+    WrapperOutputMessage message;
+    while (true) {
+      if (!client.Receive(message)) {
+        std::this_thread::yield();
+        continue;
+      }
+      if (message.type == WrapperOutputType::kControl &&
+          message.phase == MotionPhase::kHovering)
+        _exit(message.input > 0.0 ? 0 : 2);
+    }
+  }
+
+  int status = 0;
+  while (waitpid(child, &status, WNOHANG) == 0) {
+    clock->Advance(0.01);
+    adaptor.Step();
+    std::this_thread::yield();
+  }
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+  EXPECT_EQ(wrapper.GetStateHistory().Back().motion_phase,
+            MotionPhase::kHovering);
+}
+
+TEST(SharedMemoryWrapperAdaptor, ChainsTransitionsOverwrittenInTheHistory) {
+  auto name = GetChannelName("overwritten");
+  auto clock = std::make_shared<SimulatedClock>(1.0);
+  Wrapper wrapper(clock);
+  SharedMemoryChannel server;
+  ASSERT_TRUE(server.Create(name));
+  SharedMemoryWrapperAdaptor adaptor(wrapper, server);
+  SharedMemoryChannel channel;
+  ASSERT_TRUE(channel.Open(name));
+  SharedMemoryClient client(channel);
+
+  wrapper.SetPosition({1.0, 0, 0, 0.2});
+  wrapper.SetBatteryLevel(80);
+  wrapper.SetTargetPosition(TimedPosition{1.0, 3.0, 0, 1.0});
+  // more transitions than the history holds between two publishes
+  for (size_t n = 0; n < StateHistory::kCapacity; n++) {
+    clock->Advance(0.01);
+    wrapper.OnHoveringCommandCallback();
+    wrapper.OnChasingCommandCallback();
+  }
+  ASSERT_GT(wrapper.GetStateHistory().GetNumPushed(),
+            StateHistory::kCapacity + 1);
+  adaptor.Publish();
+
+  auto messages = ReceiveAll(client);
+  ASSERT_EQ(messages.size(), StateHistory::kCapacity + 1);
+  int32_t previous = MotionPhase::kIdle;
+  for (size_t n = 0; n < StateHistory::kCapacity; n++) {
+    ASSERT_EQ(messages[n].type, WrapperOutputType::kTransition);
+    EXPECT_NE(messages[n].previous, messages[n].phase) << n;
+    EXPECT_EQ(messages[n].previous, previous) << n;
+    previous = messages[n].phase;
+  }
+  EXPECT_EQ(adaptor.GetNumDropped(), 0u);
+}
@@ -0,0 +1,55 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/frontend/state_history.h"
+#include "gtest/gtest.h"
+
+using namespace my_robotics_library;
+
+TEST(StateHistory, KeepsMostRecentEntriesWhenFull) {
+  StateHistory history;
+  const size_t n_push = StateHistory::kCapacity + 10;
+  for (size_t n = 0; n < n_push; n++)
+    history.Push({n % 2 ? MotionPhase::kHovering : MotionPhase::kHolding},
+                 static_cast<double>(n));
+
+  EXPECT_EQ(history.Size(), StateHistory::kCapacity);
+  EXPECT_EQ(history.At(0).t, 10.0);
+  EXPECT_EQ(history.BackTimed().t, static_cast<double>(n_push - 1));
+  EXPECT_EQ(history.Back().motion_phase, MotionPhase::kHovering);
+  EXPECT_EQ(history.Previous().motion_phase, MotionPhase::kHolding);
+}
+
+TEST(StateHistory, QueryTransitionsSinceTime) {
+  StateHistory history;
+  for (size_t n = 0; n < StateHistory::kCapacity + 5; n++)
+    history.Push({MotionPhase::kChasing}, 0.1 * n);
+
+  EXPECT_EQ(history.CountSince(-1.0), StateHistory::kCapacity);
+  EXPECT_EQ(history.CountSince(1e9), 0);
+
+  double t_query = history.At(history.Size() - 4).t;
+  EXPECT_EQ(history.CountSince(t_query), 3);
+
+  std::vector<double> stamps;
+  history.ForEachSince(
+      t_query, [&](const TimedState &entry) { stamps.push_back(entry.t); });
+  ASSERT_EQ(stamps.size(), 3);
+  EXPECT_GT(stamps.front(), t_query);
+  EXPECT_EQ(stamps.back(), history.BackTimed().t);
+}
@@ -0,0 +1,223 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/state_machine.h"
+#include "my_robotics_library/frontend/wrapper.h"
+#include <gtest/gtest.h>
+
+using namespace my_robotics_library;
+
+TEST(StateMachine, SafetyEventsTakePriority) {
+  StateMachineInput input;
+  input.monitor.is_planning_visible = true;
+  input.is_chasing_replan_due = true;
+  EXPECT_EQ(SelectMonitorEvent(MotionPhase::kChasing, input), kChaseReplan);
+
+  input.monitor.is_safe_for_short_horizon = false;
+  EXPECT_EQ(SelectMonitorEvent(MotionPhase::kChasing, input), kHoldStop);
+  input.monitor.is_battery_enough = false;
+  EXPECT_EQ(SelectMonitorEvent(MotionPhase::kChasing, input), kLand);
+  // already landing: a low battery keeps landing even when unsafe
+  EXPECT_EQ(SelectMonitorEvent(MotionPhase::kLanding, input), kNone);
+  input.monitor.is_battery_enough = true;
+  EXPECT_EQ(SelectMonitorEvent(MotionPhase::kLanding, input), kHoldStop);
+
+  const auto &transition = GetTransition(MotionPhase::kChasing, kLand);
+  EXPECT_EQ(transition.next_phase, MotionPhase::kLanding);
+  EXPECT_EQ(transition.action, TransitionAction::kPlanLanding);
+  EXPECT_EQ(GetTransition(MotionPhase::kHovering, kExplore).guard, nullptr);
+}
+
+TEST(StateMachine, GuardedTransitionsHaveAGuard) {
+  for (size_t phase = 0; phase < kNumMotionPhases; phase++)
+    for (size_t event = 0; event < kNumMonitorEvents; event++) {
+      const auto &transition = GetTransition(
+          static_cast<MotionPhase>(phase), static_cast<MonitorEvent>(event));
+      EXPECT_EQ(transition.is_guarded, transition.guard != nullptr)
+          << phase << ", " << event;
+    }
+}
+
+TEST(StateMachine, HoldingResumesThePhaseItInterrupted) {
+  StateMachineInput input;
+  input.resume_phase = MotionPhase::kChasing;
+  input.is_target_detected = true;
+  EXPECT_EQ(SelectMonitorEvent(MotionPhase::kHolding, input), kChaseReplan);
+  input.is_target_detected = false;
+  EXPECT_EQ(SelectMonitorEvent(MotionPhase::kHolding, input), kExplore);
+  input.monitor.is_safe_for_short_horizon = false;
+  EXPECT_EQ(SelectMonitorEvent(MotionPhase::kHolding, input), kNone);
+}
+
+TEST(StateMachine, ChasingReplansOnlyWhenDue) {
+  auto clock = std::make_shared<SimulatedClock>();
+  Parameter parameter;
+  parameter.use_target_prediction = false;
+  Wrapper wrapper(parameter, clock);
+  wrapper.SetTargetPosition(TimedPosition{0, 3, 0, 0});
+  wrapper.OnChasingCommandCallback();
+  size_t num_states = wrapper.GetStateHistory().Size();
+
+  for (int n = 0; n < 10; n++) {
+    clock->Advance(0.01);
+    wrapper.OnTimerCallback();
+  }
+  EXPECT_EQ(wrapper.GetStateHistory().Size(), num_states);
+  clock->Advance(parameter.chasing_replan_period);
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetStateHistory().Size(), num_states + 1);
+}
+
+TEST(StateMachine, RecoversAfterSeveralUnsafeTicks) {
+  Wrapper wrapper;
+  wrapper.OnHoveringCommandCallback();
+  wrapper.GetObstacleManager().InsertObstacle({0, 2.5, 0, 0});
+  wrapper.SetPosition({0, 2, 0, 0});
+  for (int n = 0; n < 3; n++)
+    wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetControl().phase, MotionPhase::kHolding);
+
+  wrapper.SetPosition({0, 0, 0, 0});
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetControl().phase, MotionPhase::kHovering);
+}
+
+// With the inputs held, every phase reaches a fixed point within the
+// default budget of a tick, as ProcessEvents would drain it
+TEST(StateMachine, SettlesWhileInputsHold) {
+  const int kBudget = Parameter().max_events_per_tick;
+  for (uint32_t inputs = 0; inputs < 16; inputs++)
+    for (size_t start = 0; start < kNumMotionPhases; start++)
+      for (size_t resume = 0; resume < kNumMotionPhases; resume++) {
+        bool is_target_detected = inputs & 1;
+        bool is_chasing_replan_due = inputs & 8;
+        auto phase = static_cast<MotionPhase>(start);
+        auto resume_phase = static_cast<MotionPhase>(resume);
+        int num_transitions = 0;
+        while (true) {
+          StateMachineInput input;
+          input.monitor.is_planning_visible =
+              IsPlanningVisible(phase, is_target_detected);
+          input.monitor.is_safe_for_short_horizon = inputs & 2;
+          input.monitor.is_battery_enough = inputs & 4;
+          input.is_chasing_replan_due = is_chasing_replan_due;
+          input.is_target_detected = is_target_detected;
+          input.resume_phase = resume_phase;
+          auto event = SelectMonitorEvent(phase, input);
+          if (event == kNone)
+            break;
+          const auto &transition = GetTransition(phase, event);
+          if (transition.action == TransitionAction::kPlanChasing)
+            is_chasing_replan_due = false;
+          if (transition.next_phase == MotionPhase::kHolding)
+            resume_phase = phase;
+          phase = transition.next_phase;
+          ASSERT_LT(++num_transitions, kBudget)
+              << "inputs " << inputs << " from " << start << ", resume "
+              << resume;
+        }
+      }
+}
+
+TEST(StateMachine, LowBatteryNearAnObstacleSettlesInOneTick) {
+  Wrapper wrapper;
+  wrapper.OnHoveringCommandCallback();
+  wrapper.GetObstacleManager().InsertObstacle({0, 2.5, 0, 0});
+  wrapper.SetPosition({0, 2, 0, 0});
+  wrapper.SetBatteryLevel(0);
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetControl().phase, MotionPhase::kLanding);
+
+  auto num_pushed = wrapper.GetStateHistory().GetNumPushed();
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetStateHistory().GetNumPushed(), num_pushed);
+  EXPECT_EQ(wrapper.GetControl().phase, MotionPhase::kLanding);
+
+  // landing from a hold, as when the battery runs out while holding
+  wrapper.SetBatteryLevel(1);
+  wrapper.OnHoveringCommandCallback();
+  wrapper.OnTimerCallback();
+  ASSERT_EQ(wrapper.GetControl().phase, MotionPhase::kHolding);
+  wrapper.SetBatteryLevel(0);
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetControl().phase, MotionPhase::kLanding);
+  num_pushed = wrapper.GetStateHistory().GetNumPushed();
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetStateHistory().GetNumPushed(), num_pushed);
+}
+
+TEST(EventQueue, SettlesSeveralEventsInOneTick) {
+  Wrapper wrapper(std::make_shared<SimulatedClock>());
+  wrapper.OnHoveringCommandCallback();
+  wrapper.GetObstacleManager().InsertObstacle({0, 2.5, 0, 0});
+  wrapper.SetPosition({0, 2, 0, 0});
+  wrapper.SetTargetPosition(TimedPosition{0, 3, 0, 0});
+  wrapper.PostChasingCommand();
+  auto num_pushed = wrapper.GetStateHistory().GetNumPushed();
+
+  // hold first, then chase as commanded, which is still unsafe: the hold
+  // now resumes the chase
+  wrapper.OnTimerCallback();
+  const auto &state_history = wrapper.GetStateHistory();
+  EXPECT_EQ(state_history.GetNumPushed(), num_pushed + 3);
+  EXPECT_EQ(state_history.Back().motion_phase, MotionPhase::kHolding);
+  EXPECT_EQ(state_history.Back().resume_phase, MotionPhase::kChasing);
+  EXPECT_EQ(state_history.Previous().motion_phase, MotionPhase::kChasing);
+
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(state_history.GetNumPushed(), num_pushed + 3);
+}
+
+TEST(EventQueue, CoalescesPostedCommandsWithinBudget) {
+  Parameter parameter;
+  parameter.max_events_per_tick = 1;
+  Wrapper wrapper(parameter, std::make_shared<SimulatedClock>());
+  wrapper.SetTargetPosition(TimedPosition{0, 3, 0, 0});
+  wrapper.PostHoveringCommand();
+  wrapper.PostHoveringCommand();
+  wrapper.PostChasingCommand();
+  size_t num_states = wrapper.GetStateHistory().Size();
+
+  // one transition per tick: hovering first, the chase on the next tick
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetStateHistory().Size(), num_states + 1);
+  EXPECT_EQ(wrapper.GetStateHistory().Back().motion_phase,
+            MotionPhase::kHovering);
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetStateHistory().Back().motion_phase,
+            MotionPhase::kChasing);
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetStateHistory().Size(), num_states + 2);
+}
+
+TEST(EventQueue, DropsCommandsTheirGuardsReject) {
+  Wrapper wrapper(std::make_shared<SimulatedClock>());
+  wrapper.OnHoveringCommandCallback();
+  // no target to chase: the command is rejected, not kept for later
+  wrapper.OnChasingCommandCallback();
+  for (int n = 0; n < 5; n++)
+    wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetStateHistory().Back().motion_phase,
+            MotionPhase::kHovering);
+
+  wrapper.SetTargetPosition(TimedPosition{0, 3, 0, 0});
+  wrapper.OnTimerCallback();
+  EXPECT_EQ(wrapper.GetStateHistory().Back().motion_phase,
+            MotionPhase::kHovering);
+}
@@ -0,0 +1,82 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+#include "my_robotics_library/backend/target_predictor.h"
+#include "gtest/gtest.h"
+
+#include <random>
+
+using namespace my_robotics_library;
+using namespace my_robotics_library::backend;
+
+TEST(TargetPredictor, ConvergesToConstantVelocity) {
+  std::mt19937 generator(3);
+  std::normal_distribution<double> noise(0.0, 0.02);
+  TargetPredictor target_predictor;
+
+  for (int n = 0; n < 100; n++) {
+    double t = 0.1 * n;
+    target_predictor.AddDetection({t, 1.0 + 2.0 * t + noise(generator),
+                                   -0.5 * t + noise(generator),
+                                   1.0 + noise(generator)});
+  }
+  auto velocity = target_predictor.GetVelocity();
+  EXPECT_NEAR(velocity.x, 2.0, 0.2);
+  EXPECT_NEAR(velocity.y, -0.5, 0.2);
+  EXPECT_NEAR(velocity.z, 0.0, 0.2);
+
+  auto prediction = target_predictor.PredictPosition(10.9);
+  EXPECT_NEAR(prediction.x, 1.0 + 2.0 * 10.9, 0.3);
+  EXPECT_NEAR(prediction.y, -0.5 * 10.9, 0.3);
+}
+
+TEST(TargetPredictor, CoastsThroughMissingDetections) {
+  TargetPredictorParameter parameter;
+  parameter.lost_timeout = 0.5;
+  TargetPredictor target_predictor(parameter);
+  EXPECT_FALSE(target_predictor.HasEstimate(0.0));
+
+  for (int n = 0; n <= 20; n++)
+    target_predictor.AddDetection({0.05 * n, 0.05 * n, 0, 0});
+
+  // no detections after t = 1: prediction continues, uncertainty grows
+  EXPECT_TRUE(target_predictor.HasEstimate(1.4));
+  EXPECT_NEAR(target_predictor.PredictPosition(1.4).x, 1.4, 0.05);
+  EXPECT_GT(target_predictor.GetPositionVariance(1.4).x,
+            target_predictor.GetPositionVariance(1.1).x);
+  EXPECT_FALSE(target_predictor.HasEstimate(1.6));
+
+  // a late detection restarts the track instead of fusing a stale state
+  target_predictor.AddDetection({2.0, -3.0, 0, 0});
+  EXPECT_TRUE(target_predictor.HasEstimate(2.0));
+  EXPECT_EQ(target_predictor.PredictPosition(2.0).x, -3.0);
+  EXPECT_EQ(target_predictor.GetVelocity().x, 0.0);
+}
+
+TEST(TargetPredictor, LosesTracksStampedOnAnotherTimeBase) {
+  TargetPredictor target_predictor;
+  for (int n = 0; n <= 10; n++)
+    target_predictor.AddDetection({1e9 + 0.1 * n, 0.05 * n, 0, 0});
+  EXPECT_FALSE(target_predictor.HasEstimate(1.0));
+  EXPECT_TRUE(target_predictor.HasEstimate(1e9 + 1.0));
+
+  target_predictor.Reset();
+  for (int n = 0; n <= 10; n++)
+    target_predictor.AddDetection({-1e9 + 0.1 * n, 0.05 * n, 0, 0});
+  EXPECT_FALSE(target_predictor.HasEstimate(1.0));
+}
@@ -0,0 +1,98 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/tracing.h"
+#include "my_robotics_library/frontend/wrapper.h"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+using namespace my_robotics_library;
+
+TEST(Tracing, CountsStagesEventsAndTransitions) {
+  Tracer::Reset();
+  Wrapper wrapper;
+  wrapper.OnHoveringCommandCallback();
+  wrapper.SetBatteryLevel(0);
+  wrapper.OnTimerCallback();
+  wrapper.OnTimerCallback();
+
+#ifdef MY_ROBOTICS_LIBRARY_ENABLE_TRACING
+  EXPECT_EQ(Tracer::GetStageStatistics(TraceStage::kTimerTick).count, 2);
+  EXPECT_EQ(Tracer::GetStageStatistics(TraceStage::kHandleLanding).count, 1);
+  EXPECT_EQ(Tracer::GetEventCount(MonitorEvent::kHoverCommand), 1);
+  EXPECT_EQ(Tracer::GetEventCount(MonitorEvent::kLand), 1);
+  // one per drain of the event queue
+  EXPECT_EQ(Tracer::GetEventCount(MonitorEvent::kNone), 3);
+  EXPECT_EQ(Tracer::GetTransitionCount(MotionPhase::kIdle,
+                                       MotionPhase::kHovering),
+            1);
+  EXPECT_EQ(Tracer::GetTransitionCount(MotionPhase::kHovering,
+                                       MotionPhase::kLanding),
+            1);
+
+  std::string path = testing::TempDir() + "tracing_test.json";
+  ASSERT_TRUE(Tracer::WriteChromeTrace(path));
+  std::ifstream file(path);
+  std::string trace((std::istreambuf_iterator<char>(file)),
+                    std::istreambuf_iterator<char>());
+  EXPECT_NE(trace.find("\"name\":\"HandleLanding\""), std::string::npos);
+  EXPECT_NE(trace.find("\"kHovering->kLanding\":1"), std::string::npos);
+  std::remove(path.c_str());
+#else
+  // the macros compile away and nothing is recorded
+  EXPECT_EQ(Tracer::GetStageStatistics(TraceStage::kTimerTick).count, 0);
+  EXPECT_EQ(Tracer::GetEventCount(MonitorEvent::kLand), 0);
+#endif
+}
+
+namespace {
+// num_threads from the header of a binary trace, decoded as little-endian
+uint32_t ReadNumTracedThreads(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  unsigned char header[24] = {};
+  file.read(reinterpret_cast<char *>(header), sizeof(header));
+  uint32_t num_threads = 0;
+  for (int n = 0; n < 4; n++)
+    num_threads |= static_cast<uint32_t>(header[20 + n]) << (8 * n);
+  return num_threads;
+}
+} // namespace
+
+TEST(Tracing, ReusesBuffersOfExitedThreads) {
+  std::string path = testing::TempDir() + "tracing_test.bin";
+  ASSERT_TRUE(Tracer::WriteBinaryTrace(path));
+  uint32_t num_threads = ReadNumTracedThreads(path);
+  auto count = Tracer::GetStageStatistics(TraceStage::kPlanning).count;
+
+  for (int n = 0; n < 20; n++)
+    std::thread([] {
+      Tracer::RecordStage(TraceStage::kPlanning, 0, 10);
+    }).join();
+
+  ASSERT_TRUE(Tracer::WriteBinaryTrace(path));
+  EXPECT_LE(ReadNumTracedThreads(path), num_threads + 1);
+  // the exited threads still count
+  EXPECT_EQ(Tracer::GetStageStatistics(TraceStage::kPlanning).count,
+            count + 20);
+  std::remove(path.c_str());
+}
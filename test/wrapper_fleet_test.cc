@@ -0,0 +1,148 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+#include "my_robotics_library/frontend/wrapper.h"
+#include "my_robotics_library/frontend/wrapper_fleet.h"
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+using namespace my_robotics_library;
+
+namespace {
+
+void ExpectSameControl(const Control &expected, const Control &actual) {
+  EXPECT_EQ(expected.phase, actual.phase);
+  EXPECT_DOUBLE_EQ(expected.t, actual.t);
+  EXPECT_DOUBLE_EQ(expected.input, actual.input);
+}
+
+} // namespace
+
+TEST(WrapperFleet, MatchesIndependentWrappers) {
+  // more than one block, so ticks are sharded
+  const size_t num_vehicles = 66;
+  auto clock = std::make_shared<SimulatedClock>();
+  ThreadPool thread_pool(2);
+  WrapperFleet fleet(num_vehicles, Parameter(), clock, thread_pool);
+  std::vector<std::unique_ptr<Wrapper>> wrappers;
+  for (size_t i = 0; i < num_vehicles; i++)
+    wrappers.emplace_back(new Wrapper(clock));
+
+  // an obstacle some chasing plans run into
+  fleet.GetObstacleManager().InsertObstacle({0, 3, 0, 0.9});
+  for (auto &wrapper : wrappers)
+    wrapper->GetObstacleManager().InsertObstacle({0, 3, 0, 0.9});
+
+  for (int n = 0; n < 80; n++) {
+    clock->Advance(0.01);
+    double t = clock->Now();
+    for (size_t i = 0; i < num_vehicles; i++) {
+      auto &wrapper = *wrappers[i];
+      TimedPosition position{t, 0.05 * (i % 7) * (i % 3), 0, 0.01 * n};
+      TimedVelocity velocity{t, 0.1, 0, 0.5};
+      fleet.SetPosition(i, position);
+      wrapper.SetPosition(position);
+      fleet.SetVelocity(i, velocity);
+      wrapper.SetVelocity(velocity);
+
+      std::optional<TimedPosition> target;
+      if (n > 5 + static_cast<int>(i % 5) && n % (15 + i % 11) != 0)
+        target = TimedPosition{t, 2 + 0.5 * t, 0.1 * (i % 4), 0};
+      fleet.SetTargetPosition(i, target);
+      wrapper.SetTargetPosition(target);
+
+      int battery_level = n < 60 + static_cast<int>(i % 15) ? 1 : 0;
+      fleet.SetBatteryLevel(i, battery_level);
+      wrapper.SetBatteryLevel(battery_level);
+
+      if (n == static_cast<int>(i % 4)) {
+        fleet.PostHoveringCommand(i);
+        wrapper.PostHoveringCommand();
+      }
+      if (n == 20 + static_cast<int>(i % 9)) {
+        fleet.PostChasingCommand(i);
+        wrapper.PostChasingCommand();
+      }
+    }
+
+    fleet.Tick();
+    for (auto &wrapper : wrappers)
+      wrapper->OnTimerCallback();
+
+    for (size_t i = 0; i < num_vehicles; i++) {
+      const auto &history = wrappers[i]->GetStateHistory();
+      ASSERT_EQ(history.Back().motion_phase, fleet.GetMotionPhase(i))
+          << "vehicle " << i << " tick " << n;
+      EXPECT_EQ(std::min<size_t>(history.Size(), StateHistory::kCapacity),
+                std::min<uint64_t>(fleet.GetNumTransitions(i),
+                                   StateHistory::kCapacity));
+      ExpectSameControl(wrappers[i]->GetControl(), fleet.GetControl(i));
+    }
+  }
+}
+
+TEST(WrapperFleet, VisitsEveryFlightPhase) {
+  auto clock = std::make_shared<SimulatedClock>();
+  WrapperFleet fleet(1, Parameter(), clock);
+  EXPECT_EQ(fleet.GetMotionPhase(0), MotionPhase::kIdle);
+
+  fleet.PostHoveringCommand(0);
+  clock->Advance(0.01);
+  fleet.Tick();
+  EXPECT_EQ(fleet.GetMotionPhase(0), MotionPhase::kHovering);
+
+  fleet.SetTargetPosition(0, TimedPosition{clock->Now(), 2, 0, 0});
+  fleet.PostChasingCommand(0);
+  clock->Advance(0.01);
+  fleet.Tick();
+  EXPECT_EQ(fleet.GetMotionPhase(0), MotionPhase::kChasing);
+
+  fleet.SetTargetPosition(0, std::nullopt);
+  clock->Advance(0.01);
+  fleet.Tick();
+  EXPECT_EQ(fleet.GetMotionPhase(0), MotionPhase::kExploration);
+
+  fleet.SetBatteryLevel(0, 0);
+  clock->Advance(0.01);
+  fleet.Tick();
+  EXPECT_EQ(fleet.GetMotionPhase(0), MotionPhase::kLanding);
+}
+
+TEST(WrapperFleet, DropsCommandsTheirGuardsReject) {
+  auto clock = std::make_shared<SimulatedClock>();
+  WrapperFleet fleet(1, Parameter(), clock);
+  fleet.PostHoveringCommand(0);
+  clock->Advance(0.01);
+  fleet.Tick();
+
+  // no target to chase: the command is rejected, not kept for later
+  fleet.PostChasingCommand(0);
+  for (int n = 0; n < 5; n++) {
+    clock->Advance(0.01);
+    fleet.Tick();
+  }
+  EXPECT_EQ(fleet.GetMotionPhase(0), MotionPhase::kHovering);
+
+  fleet.SetTargetPosition(0, TimedPosition{clock->Now(), 2, 0, 0});
+  clock->Advance(0.01);
+  fleet.Tick();
+  EXPECT_EQ(fleet.GetMotionPhase(0), MotionPhase::kHovering);
+}
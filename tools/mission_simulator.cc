@@ -0,0 +1,58 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Boseong Felipe Jeon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *******************************************************************************/
+
+
+// Evaluates the default Parameter over randomized missions.
+// usage: mission_simulator [num_episodes] [seed]
+
+#include "my_robotics_library/frontend/mission_simulator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace my_robotics_library;
+
+int main(int argc, char **argv) {
+  size_t num_episodes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000;
+  MissionSimulatorOptions options;
+  if (argc > 2)
+    options.seed = std::strtoull(argv[2], nullptr, 10);
+
+  auto start = std::chrono::steady_clock::now();
+  auto statistics = SimulateMissions(options, num_episodes);
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  static const char *kPhaseNames[kNumMotionPhases] = {
+      "landing", "holding", "exploration", "chasing", "hovering", "idle"};
+  std::printf("episodes           %zu (%.1f s on %zu threads)\n",
+              statistics.num_episodes, elapsed,
+              GetDefaultThreadPool().GetNumThreads());
+  for (size_t phase = 0; phase < kNumMotionPhases; phase++)
+    std::printf("time %-13s %.2f s\n", kPhaseNames[phase],
+                statistics.mean_time_in_phase[phase]);
+  std::printf("landing rate       %.3f\n", statistics.landing_rate);
+  std::printf("flight time        %.2f s\n", statistics.mean_flight_time);
+  std::printf("hold-stops         %.2f (rate %.3f)\n",
+              statistics.mean_hold_stops, statistics.hold_stop_rate);
+  std::printf("target losses      %.2f\n", statistics.mean_target_losses);
+  std::printf("chasing plans      %.2f\n", statistics.mean_chasing_plans);
+  return 0;
+}